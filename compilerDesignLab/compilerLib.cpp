@@ -0,0 +1,87 @@
+#include "compilerLib.h"
+#include "semantic.h"
+#include "interpreter.h"
+#include <sstream>
+
+namespace cdl {
+
+struct Context::Impl {
+    interp::Env env;
+    std::ostringstream out;
+    std::string line;
+};
+
+Context::Context():impl(std::make_unique<Impl>()){}
+Context::~Context()=default;
+
+// Calls f(line, lineNo) for each line of src, split like std::getline.
+template<class F> static void forEachLine(std::string_view src, std::string& line, F f){
+    int no=0; size_t pos=0;
+    while (pos<src.size()) {
+        size_t nl=src.find('\n',pos);
+        if (nl==std::string_view::npos) nl=src.size();
+        line.assign(src.data()+pos,nl-pos); pos=nl+1;
+        f(line,++no);
+    }
+}
+
+// semantic.h messages carry a "Line N: " prefix; lift it into Diagnostic::line.
+static Diagnostic fromText(Diagnostic::Severity sev, const std::string& text){
+    Diagnostic d{sev,0,text};
+    if (text.compare(0,5,"Line ")==0) {
+        size_t colon=text.find(": ",5);
+        if (colon!=std::string::npos) { d.line=std::atoi(text.c_str()+5); d.message=text.substr(colon+2); }
+    }
+    return d;
+}
+
+bool Context::analyze(std::string_view src, const Callbacks& cb, const AnalyzeOptions& opt){
+    std::lock_guard<std::mutex> lock(m);
+    sema::ExprPool pool; pool.hashCons=opt.hashCons;
+    std::vector<std::unique_ptr<sema::Stmt>> program;
+    std::vector<std::string> warnings;
+    std::string err;
+    bool syntaxOk=true;
+    forEachLine(src, impl->line, [&](const std::string& raw, int no){
+        if (!syntaxOk) return;
+        std::string t=sema::trim(raw);
+        if (!t.empty() && !sema::parseLine(t,no,pool,program,warnings,err)) syntaxOk=false;
+    });
+    if (cb.onDiagnostic) for (auto& w: warnings) cb.onDiagnostic(fromText(Diagnostic::Severity::Warning,w));
+    if (!syntaxOk) {
+        if (cb.onDiagnostic) cb.onDiagnostic(fromText(Diagnostic::Severity::Error,err));
+        return false;
+    }
+
+    sema::Semantic sem; sem.analyze(program);
+    if (cb.onDiagnostic) for (auto& e: sem.errors) cb.onDiagnostic(fromText(Diagnostic::Severity::Error,e));
+    if (cb.onStatement) for (auto& s: program) {
+        auto& A=sem.get(s.get());
+        StatementInfo info{s->line,StatementInfo::Kind::Print,"",A.type==sema::Type::Int,A.isConst,A.constVal};
+        if (auto d=dynamic_cast<const sema::Decl*>(s.get())) { info.kind=StatementInfo::Kind::Decl; info.name=d->name; }
+        else if (dynamic_cast<const sema::Begin*>(s.get())) info.kind=StatementInfo::Kind::BlockBegin;
+        else if (dynamic_cast<const sema::End*>(s.get())) info.kind=StatementInfo::Kind::BlockEnd;
+        cb.onStatement(info);
+    }
+    return sem.errors.empty();
+}
+
+bool Context::evaluate(std::string_view src, const Callbacks& cb){
+    std::lock_guard<std::mutex> lock(m);
+    interp::Env& env=impl->env; env.types.clear(); env.values.clear();
+    std::ostringstream& out=impl->out;
+    bool ok=true;
+    auto onError=[&](const interp::Line& l, const char* what){
+        ok=false;
+        if (cb.onDiagnostic)
+            cb.onDiagnostic({Diagnostic::Severity::Error,(int)l.no,what? std::string(what) : "Syntax Error: "+l.text});
+    };
+    forEachLine(src, impl->line, [&](const std::string& raw, int no){
+        out.str("");
+        interp::run_with(interp::classify(raw,no),env,out,onError);
+        if (cb.onOutput && out.tellp()>0) { std::string s=out.str(); cb.onOutput(s); }
+    });
+    return ok;
+}
+
+} // namespace cdl
@@ -0,0 +1,76 @@
+// compilerLib.h - in-process API for the lab front ends, so a host can
+// analyze or run a program without spawning a binary or writing editor.txt.
+//
+//   cdl::Context ctx;
+//   cdl::Callbacks cb;
+//   cb.onOutput     = [](std::string_view s){ ... };        // evaluate()
+//   cb.onStatement  = [](const cdl::StatementInfo& s){ ... }; // analyze()
+//   cb.onDiagnostic = [](const cdl::Diagnostic& d){ ... };
+//   ctx.evaluate("integer a te 5\ndekhao(a*2)\n", cb);
+//
+// Build: compile compilerLib.cpp with the host (g++ -std=c++17 -c compilerLib.cpp).
+#ifndef COMPILER_LIB_H
+#define COMPILER_LIB_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace cdl {
+
+struct Diagnostic {
+    enum class Severity { Warning, Error };
+    Severity severity;
+    int line;               // 1-based, 0 when not tied to a line
+    std::string message;
+};
+
+// One annotated top-level statement reported by analyze().
+struct StatementInfo {
+    int line;
+    enum class Kind { Decl, Print, BlockBegin, BlockEnd } kind;
+    std::string name;       // declared name (Decl only)
+    bool typeKnown;         // type is int (false: analysis found an error below)
+    bool isConst;
+    long long value;        // folded value when isConst
+};
+
+struct Callbacks {
+    std::function<void(const Diagnostic&)> onDiagnostic;
+    std::function<void(const StatementInfo&)> onStatement;   // analyze()
+    std::function<void(std::string_view)> onOutput;          // evaluate(): one printed line, '\n' included
+};
+
+struct AnalyzeOptions { bool hashCons=false; };
+
+// Reusable context. evaluate() reuses its environment and output buffer
+// between calls; analyze() builds a fresh expression pool, tree and symbol
+// table for every call. Calls on one context are serialized by an internal
+// mutex; separate contexts share no state and can be used from different
+// threads at the same time.
+class Context {
+public:
+    Context();
+    ~Context();
+    Context(const Context&)=delete;
+    Context& operator=(const Context&)=delete;
+
+    // semantic.cpp front end (integer declarations, single-expression dekhao).
+    // Returns false on a syntax error or any semantic error.
+    bool analyze(std::string_view src, const Callbacks& cb, const AnalyzeOptions& opt={});
+
+    // main.cpp interpreter (integer/float declarations, multi-argument dekhao).
+    // Each call starts from an empty environment. Returns false if any line failed.
+    bool evaluate(std::string_view src, const Callbacks& cb);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+    std::mutex m;
+};
+
+} // namespace cdl
+
+#endif
@@ -8,17 +8,74 @@
 #include <cmath>
 #include <iomanip>
 #include <stdexcept>
+#include <cstdint>
+#include <climits>
 
 // Simple type system for variables in our mini language
 enum class Type { INT, FLOAT };
 
-// Runtime environment to store variable types and values
+// A typed value: integers are kept as exact 64-bit ints, floats as doubles
+struct Value {
+    Type type = Type::INT;
+    int64_t i = 0;      // valid when type == INT
+    double f = 0;       // valid when type == FLOAT
+
+    static Value of(int64_t v) { Value r; r.type = Type::INT; r.i = v; return r; }
+    static Value of(double v)  { Value r; r.type = Type::FLOAT; r.f = v; return r; }
+    double asDouble() const { return type == Type::INT ? (double)i : f; }
+};
+
+// Runtime environment: variable -> declared type and value
 struct Env {
-    std::unordered_map<std::string, Type> types;   // variable -> declared type
-    std::unordered_map<std::string, double> values; // variable -> current value (stored as double)
-    bool hasVar(const std::string& n) const { return values.find(n) != values.end(); }
+    std::unordered_map<std::string, Value> vars;
+    bool hasVar(const std::string& n) const { return vars.find(n) != vars.end(); }
 };
 
+// Arithmetic for one representation, chosen at compile time.
+// Returns false when the int64 result would overflow or is not exact
+// (integer division with a remainder); the caller then redoes the
+// operation in double, which is what the old all-double evaluator did.
+template <class T> bool arith(char op, T a, T b, T& out);
+
+template <> inline bool arith<int64_t>(char op, int64_t a, int64_t b, int64_t& out) {
+    switch (op) {
+        case '+': return !__builtin_add_overflow(a, b, &out);
+        case '-': return !__builtin_sub_overflow(a, b, &out);
+        case '*': return !__builtin_mul_overflow(a, b, &out);
+        default:  // '/'
+            if (b == 0) throw std::runtime_error("Division by zero");
+            if ((a == INT64_MIN && b == -1) || a % b != 0) return false;
+            out = a / b; return true;
+    }
+}
+
+template <> inline bool arith<double>(char op, double a, double b, double& out) {
+    switch (op) {
+        case '+': out = a + b; break;
+        case '-': out = a - b; break;
+        case '*': out = a * b; break;
+        default:  // '/'
+            if (fabs(b) < 1e-15) throw std::runtime_error("Division by zero");
+            out = a / b;
+    }
+    return true;
+}
+
+// Apply op to two values: int op int stays on the int64 path; a FLOAT
+// operand (or an inexact integer result) promotes the operation to double.
+// Only the arithmetic is specialized at compile time: an operand's type is
+// known only at run time (variables, literals, promotion after overflow),
+// so the parser carries the tagged Value and picks the path per operation.
+inline Value combine(char op, const Value& a, const Value& b) {
+    if (a.type == Type::INT && b.type == Type::INT) {
+        int64_t r;
+        if (arith<int64_t>(op, a.i, b.i, r)) return Value::of(r);
+    }
+    double r;
+    arith<double>(op, a.asDouble(), b.asDouble(), r);
+    return Value::of(r);
+}
+
 // A tiny expression parser (recursive descent) for +, -, *, /, parentheses, numbers, and variables
 struct Parser {
     std::string s;      // the expression text
@@ -37,8 +94,9 @@ struct Parser {
         return false;
     }
 
-    // Parse a number with optional sign and decimal point
-    double parse_number() {
+    // Parse a number with optional sign and decimal point.
+    // Without a decimal point it is an exact int64 (double if it does not fit).
+    Value parse_number() {
         skip();
         size_t st = i; bool dot = false;
         if (i < s.size() && (s[i] == '+' || s[i] == '-')) ++i;
@@ -46,8 +104,18 @@ struct Parser {
             if (s[i] == '.') { if (dot) break; dot = true; }
             ++i;
         }
+        // Integer fast path: accumulate digits directly, no substring
+        if (!dot) {
+            size_t k = st; bool neg = false;
+            if (s[k] == '+' || s[k] == '-') neg = s[k++] == '-';
+            int64_t v = 0; bool ok = k < i;
+            for (; ok && k < i; ++k)
+                ok = !__builtin_mul_overflow(v, 10, &v) &&
+                     !(neg ? __builtin_sub_overflow(v, s[k] - '0', &v) : __builtin_add_overflow(v, s[k] - '0', &v));
+            if (ok) return Value::of(v);
+        }
         // std::stod throws on invalid; caller catches at top level
-        return std::stod(s.substr(st, i - st));
+        return Value::of(std::stod(s.substr(st, i - st)));
     }
 
     // Parse an identifier: [A-Za-z_][A-Za-z0-9_]*
@@ -61,10 +129,10 @@ struct Parser {
     }
 
     // factor := NUMBER | VARIABLE | '(' expr ')'
-    double factor() {
+    Value factor() {
         skip();
         if (match('(')) {
-            double v = expr();
+            Value v = expr();
             if (!match(')')) throw std::runtime_error("Missing )");
             return v;
         }
@@ -73,36 +141,31 @@ struct Parser {
 
         // If not number/paren, expect a variable
         std::string id = parse_identifier();
-        if (!env->hasVar(id)) throw std::runtime_error("Undefined variable: " + id);
-        return env->values[id];
+        auto it = env->vars.find(id);
+        if (it == env->vars.end()) throw std::runtime_error("Undefined variable: " + id);
+        return it->second;
     }
 
     // term := factor (('*' factor) | ('/' factor))*
-    double term() {
-        double v = factor();
+    Value term() {
+        Value v = factor();
         while (true) {
             skip();
-            if (match('*')) {
-                v *= factor();
-            } else if (match('/')) {
-                double r = factor();
-                if (fabs(r) < 1e-15) throw std::runtime_error("Division by zero");
-                v /= r;
-            } else break;
+            if (match('*'))      v = combine('*', v, factor());
+            else if (match('/')) v = combine('/', v, factor());
+            else break;
         }
         return v;
     }
 
     // expr := term (('+' term) | ('-' term))*
-    double expr() {
-        double v = term();
+    Value expr() {
+        Value v = term();
         while (true) {
             skip();
-            if (match('+')) {
-                v += term();
-            } else if (match('-')) {
-                v -= term();
-            } else break;
+            if (match('+'))      v = combine('+', v, term());
+            else if (match('-')) v = combine('-', v, term());
+            else break;
         }
         return v;
     }
@@ -129,6 +192,9 @@ int main() {
     //   dekhao(a, b, "=", a+b)
     std::regex print_re(R"(^\s*dekhao\(\s*(.+)\s*\)\s*$)");
 
+    // Leading/trailing whitespace of an argument (built once, used per argument)
+    std::regex trim_re(R"(^\s+|\s+$)");
+
     while (std::getline(f, line)) {
         if (line.empty()) continue;      // ignore blank lines
         std::smatch m;
@@ -137,13 +203,21 @@ int main() {
         if (std::regex_match(line, m, decl)) {
             std::string type = m[1];          // "integer" or "float"
             std::string var  = m[2];          // variable name
-            double val = std::stod(m[3]);     // initial value (as double)
+            std::string lit  = m[3];          // initial value as written
 
             // Store declared type, and normalize value:
-            // - integers are rounded to nearest integer
+            // - integers are exact int64 (a fractional literal is rounded to nearest)
             // - floats are stored as-is
-            if (type == "integer") { env.types[var] = Type::INT;   env.values[var] = round(val); }
-            else                    { env.types[var] = Type::FLOAT; env.values[var] = val; }
+            if (type == "integer") {
+                bool frac = lit.find('.') != std::string::npos;
+                try {
+                    env.vars[var] = Value::of(frac ? (int64_t)llround(std::stod(lit)) : (int64_t)std::stoll(lit));
+                } catch (const std::out_of_range&) {
+                    std::cerr << "Error: integer value out of range: " << lit << "\n";
+                }
+            } else {
+                env.vars[var] = Value::of(std::stod(lit));
+            }
             continue;
         }
 
@@ -161,7 +235,7 @@ int main() {
                     std::string part = token; token.clear();
 
                     // Trim leading/trailing spaces
-                    part = std::regex_replace(part, std::regex(R"(^\s+|\s+$)"), "");
+                    part = std::regex_replace(part, trim_re, "");
 
                     if (!part.empty()) {
                         // If the part is a string literal "..."
@@ -172,11 +246,15 @@ int main() {
                             // Otherwise, treat as an expression: parse and evaluate
                             try {
                                 Parser p(part, &env);
-                                double val = p.expr();
+                                Value val = p.expr();
 
-                                // Pretty-print: integers without decimal, floats with precision
-                                if (is_int_like(val)) std::cout << (long long)llround(val);
-                                else                  std::cout << std::setprecision(12) << val;
+                                // Pretty-print: integers exactly; floats without decimal
+                                // when integral and within long long (llround is undefined
+                                // outside it), otherwise with precision
+                                if (val.type == Type::INT) std::cout << (long long)val.i;
+                                else if (is_int_like(val.f) && val.f >= -0x1p63 && val.f < 0x1p63)
+                                    std::cout << (long long)llround(val.f);
+                                else std::cout << std::setprecision(12) << val.f;
                             } catch (const std::exception& e) {
                                 std::cerr << "\nError: " << e.what() << "\n";
                             }
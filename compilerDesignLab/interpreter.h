@@ -0,0 +1,284 @@
+// interpreter.h - line classifier and evaluator for the integer/float
+// dekhao language. Used by main.cpp and compilerLib.
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+namespace interp {
+
+enum class Type { INT, FLOAT };
+
+struct Env {
+    std::unordered_map<std::string, Type> types;
+    std::unordered_map<std::string, double> values;
+    bool hasVar(const std::string& n) const { return values.find(n) != values.end(); }
+};
+
+struct Parser {
+    std::string s; size_t i=0; Env* env;
+    Parser(const std::string& str, Env* e): s(str), env(e) {}
+    void skip(){while(i<s.size()&&isspace((unsigned char)s[i]))++i;}
+    bool match(char c){skip(); if(i<s.size()&&s[i]==c){++i;return true;}return false;}
+    double parse_number(){
+        skip(); size_t st=i; bool dot=false;
+        if(i<s.size()&&(s[i]=='+'||s[i]=='-'))++i;
+        while(i<s.size()&&(isdigit((unsigned char)s[i])||s[i]=='.')){
+            if(s[i]=='.'){if(dot)break;dot=true;}++i;
+        }
+        return std::stod(s.substr(st,i-st));
+    }
+    std::string parse_identifier(){
+        skip(); if(i>=s.size()||!(isalpha((unsigned char)s[i])||s[i]=='_'))
+            throw std::runtime_error("Expected identifier");
+        size_t st=i++;
+        while(i<s.size()&&(isalnum((unsigned char)s[i])||s[i]=='_'))++i;
+        return s.substr(st,i-st);
+    }
+    // number or variable; parentheses are handled by expr()
+    double factor(){
+        skip();
+        if(i<s.size()&&(isdigit((unsigned char)s[i])||s[i]=='+'||s[i]=='-'))return parse_number();
+        std::string id=parse_identifier();
+        auto it=env->values.find(id);  // read-only: safe on a shared Env
+        if(it==env->values.end())throw std::runtime_error("Undefined variable: "+id);
+        return it->second;
+    }
+    // Operator-precedence evaluation with explicit operand/operator stacks
+    // ('(' stays on the operator stack as a marker), so neither nesting depth
+    // nor expression length uses native stack. The stacks are reused by every
+    // call on the thread. Operators are applied in the same order as
+    // recursive expr/term/factor would apply them, so values and the first
+    // error raised are unchanged.
+    double expr(){
+        static thread_local std::vector<double> vals;
+        static thread_local std::vector<char> ops;
+        vals.clear(); ops.clear();
+        auto prec=[](char op){return op=='*'||op=='/'?2:op=='('?0:1;};
+        auto reduce=[&]{
+            char op=ops.back(); ops.pop_back();
+            double r=vals.back(); vals.pop_back(); double& v=vals.back();
+            switch(op){
+            case '+': v+=r; break;
+            case '-': v-=r; break;
+            case '*': v*=r; break;
+            default: if(fabs(r)<1e-15)throw std::runtime_error("Division by zero"); v/=r;
+            }
+        };
+        while(true){
+            while(match('('))ops.push_back('(');
+            vals.push_back(factor());
+            // after an operand: operator, ')' or end of expression
+            while(true){
+                skip();
+                char c=i<s.size()?s[i]:'\0';
+                if(c=='+'||c=='-'||c=='*'||c=='/'){
+                    while(!ops.empty()&&prec(ops.back())>=prec(c))reduce();
+                    ops.push_back(c); ++i; break;
+                }
+                while(!ops.empty()&&ops.back()!='(')reduce();
+                if(ops.empty())return vals.back();
+                if(!match(')'))throw std::runtime_error("Missing )");
+                ops.pop_back();
+            }
+        }
+    }
+};
+
+inline bool is_int_like(double x){return fabs(x-round(x))<1e-9;}
+
+// One classified source line. Classification (pattern match, argument split)
+// never touches Env, so the pipelined mode runs it ahead of evaluation.
+struct Line {
+    enum Kind { BLANK, DECL, PRINT, BAD } kind=BLANK;
+    size_t no=0;                      // 1-based source line number
+    std::string text;                 // BAD: raw line, DECL: variable name
+    bool isInt=false; double val=0;   // DECL
+    std::vector<std::string> parts;   // PRINT: trimmed arguments (empty ones kept for spacing)
+    std::string src;                  // raw line, pipelined --profile only
+};
+
+// Hand-written equivalents of the line grammar's regexes
+//   declaration  ^\s*(integer|float)\s+([A-Za-z_]\w*)\s+te\s+(-?\d+(?:\.\d+)?)\s*$
+//   print        ^\s*dekhao\(\s*(.+)\s*\)\s*$
+// (std::regex recurses per character and overflows the stack on long lines).
+// \s is isspace in the "C" locale; '.' is any byte but '\n' and '\r'.
+namespace lex {
+inline bool sp(char c){return isspace((unsigned char)c)!=0;}
+inline bool word(char c){return isalnum((unsigned char)c)||c=='_';}
+inline bool dig(char c){return isdigit((unsigned char)c)!=0;}
+inline size_t spaces(const std::string& s, size_t i){while(i<s.size()&&sp(s[i]))++i;return i;}
+inline bool lit(const std::string& s, size_t& i, const char* w){
+    size_t n=strlen(w); if(s.compare(i,n,w)!=0)return false; i+=n; return true;
+}
+inline bool decl(const std::string& s, Line& l){
+    size_t i=spaces(s,0);
+    bool isInt=lit(s,i,"integer"); if(!isInt&&!lit(s,i,"float"))return false;
+    size_t j=spaces(s,i); if(j==i)return false;
+    if(j>=s.size()||!(isalpha((unsigned char)s[j])||s[j]=='_'))return false;
+    size_t n=j; while(n<s.size()&&word(s[n]))++n;
+    i=spaces(s,n); if(i==n||!lit(s,i,"te"))return false;
+    size_t v=spaces(s,i); if(v==i)return false;
+    i=v; if(i<s.size()&&s[i]=='-')++i;
+    size_t d=i; while(i<s.size()&&dig(s[i]))++i; if(i==d)return false;
+    if(i<s.size()&&s[i]=='.'){d=++i; while(i<s.size()&&dig(s[i]))++i; if(i==d)return false;}
+    size_t e=i; if(spaces(s,i)!=s.size())return false;
+    l.text=s.substr(j,n-j); l.isInt=isInt; l.val=std::stod(s.substr(v,e-v));
+    return true;
+}
+// On a match sets [b,e) to the capture group: everything between the
+// leading blanks after '(' and the last ')', minus trailing blanks that
+// '.' cannot take ('\n'/'\r' and the blanks after them).
+inline bool print(const std::string& s, size_t& b, size_t& e){
+    size_t i=spaces(s,0);
+    if(!lit(s,i,"dekhao("))return false;
+    size_t r=s.size(); while(r>i&&sp(s[r-1]))--r;
+    if(r==i||s[r-1]!=')')return false;
+    --r; b=spaces(s,i); if(b>r)b=r;
+    e=r; for(size_t k=b;k<r;++k)if(s[k]=='\n'||s[k]=='\r'){e=k;break;}
+    if(spaces(s,e)<r)return false;
+    if(e>b)return true;
+    // blank argument list: the group takes one blank that '.' can match
+    for(size_t k=r;k>i;--k)if(s[k-1]!='\n'&&s[k-1]!='\r'){b=k-1;e=k;return true;}
+    return false;
+}
+inline std::string trim(const std::string& s){
+    size_t b=spaces(s,0), e=s.size(); while(e>b&&sp(s[e-1]))--e;
+    return s.substr(b,e-b);
+}
+} // namespace lex
+
+inline Line classify(const std::string& line, size_t no){
+    Line l; l.no=no; if(line.empty())return l;
+    // variable declaration
+    if(lex::decl(line,l)){l.kind=Line::DECL;return l;}
+    // print
+    size_t b,e;
+    if(lex::print(line,b,e)){
+        l.kind=Line::PRINT;
+        // split by commas not inside quotes
+        bool in_str=false; size_t st=b;
+        for(size_t i=b;i<=e;++i){
+            if(i==e||(!in_str&&line[i]==',')){
+                // trim
+                l.parts.push_back(lex::trim(line.substr(st,i-st))); st=i+1;
+            }else if(line[i]=='"')in_str=!in_str;
+        }
+        return l;
+    }
+    l.kind=Line::BAD; l.text=line; return l;
+}
+
+// --profile: execution count and steady_clock time per source line and per
+// dekhao argument. run() only touches it through a null-checked pointer, so
+// the unprofiled path costs one branch per line/argument.
+struct Profiler {
+    using clock=std::chrono::steady_clock;
+    struct Stat { unsigned long long count=0, ns=0; };
+    std::vector<Stat> lines;               // [line number]
+    std::vector<std::vector<Stat>> args;   // [line number][argument index]
+    std::vector<std::string> text;         // [line number] source, for the report
+
+    static unsigned long long since(clock::time_point t0){
+        return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now()-t0).count();
+    }
+    void line(const Line& l, const std::string& src, unsigned long long ns){
+        if(lines.size()<=l.no){lines.resize(l.no+1);args.resize(l.no+1);text.resize(l.no+1);}
+        ++lines[l.no].count; lines[l.no].ns+=ns;
+        if(text[l.no].empty())text[l.no]=src.substr(0,60);
+    }
+    void arg(const Line& l, size_t i, unsigned long long ns){
+        if(args.size()<=l.no)args.resize(l.no+1);
+        auto& a=args[l.no]; if(a.size()<=i)a.resize(i+1);
+        ++a[i].count; a[i].ns+=ns;
+    }
+
+    // report: lines sorted by total time; folded: "file:line;argN ns" stacks
+    // (line self time on the bare "file:line" frame) for flamegraph.pl.
+    void write(const std::string& report, const std::string& folded, const std::string& file) const {
+        unsigned long long total=0;
+        std::vector<size_t> order;
+        for(size_t n=1;n<lines.size();++n)if(lines[n].count){order.push_back(n);total+=lines[n].ns;}
+        std::stable_sort(order.begin(),order.end(),[&](size_t a,size_t b){return lines[a].ns>lines[b].ns;});
+        std::ofstream r(report);
+        r<<"line      count     total_us    %     source\n";
+        for(size_t n:order){
+            const Stat& s=lines[n];
+            r<<std::left<<std::setw(10)<<n<<std::setw(10)<<s.count<<std::setw(12)<<std::fixed<<std::setprecision(1)<<s.ns/1e3
+             <<std::setw(6)<<(total?100.0*s.ns/total:0.0)<<text[n]<<"\n";
+            for(size_t i=0;i<args[n].size();++i)if(args[n][i].count)
+                r<<"  arg "<<std::setw(4)<<i+1<<std::setw(10)<<args[n][i].count<<std::setw(12)<<args[n][i].ns/1e3<<"\n";
+        }
+        std::ofstream f(folded);
+        for(size_t n:order){
+            unsigned long long self=lines[n].ns;
+            for(size_t i=0;i<args[n].size();++i)if(args[n][i].ns){
+                f<<file<<":"<<n<<";arg"<<i+1<<" "<<args[n][i].ns<<"\n";
+                self-=std::min(self,args[n][i].ns);
+            }
+            if(self)f<<file<<":"<<n<<" "<<self<<"\n";
+        }
+    }
+};
+
+// Executes one classified line. onError(line, what) is called with the
+// exception text of a failed dekhao argument, or what==nullptr for a line
+// that is not a statement.
+template<class OnError>
+void run_with(const Line& l, Env& env, std::ostream& out, OnError&& onError, Profiler* prof=nullptr){
+    switch(l.kind){
+    case Line::BLANK: return;
+    case Line::DECL:
+        if(l.isInt){env.types[l.text]=Type::INT;env.values[l.text]=round(l.val);}
+        else{env.types[l.text]=Type::FLOAT;env.values[l.text]=l.val;}
+        return;
+    case Line::PRINT:
+        for(size_t i=0;i<l.parts.size();++i){
+            const std::string& part=l.parts[i];
+            Profiler::clock::time_point t0; if(prof)t0=Profiler::clock::now();
+            if(!part.empty()){
+                if(part.size()>=2&&part.front()=='"'&&part.back()=='"'){
+                    out.write(part.data()+1,part.size()-2);
+                }else{
+                    try{
+                        Parser p(part,&env);
+                        double val=p.expr();
+                        if(is_int_like(val))out<<(long long)llround(val);
+                        else out<<std::setprecision(12)<<val;
+                    }catch(const std::exception&e){
+                        onError(l,e.what());
+                    }
+                }
+            }
+            if(prof)prof->arg(l,i,Profiler::since(t0));
+            if(i+1<l.parts.size())out<<" ";
+        }
+        out<<"\n";
+        return;
+    case Line::BAD:
+        onError(l,nullptr);
+        return;
+    }
+}
+
+// run_with() reporting errors to err in the interpreter's stderr format.
+inline void run(const Line& l, Env& env, std::ostream& out, std::ostream& err, Profiler* prof=nullptr){
+    run_with(l,env,out,[&](const Line& bad,const char* what){
+        if(what)err<<"\nError: "<<what<<"\n"; else err<<"Syntax Error: "<<bad.text<<"\n";
+    },prof);
+}
+
+} // namespace interp
+
+#endif
@@ -0,0 +1,69 @@
+// Benchmark: compilerLib in-process calls vs spawning the interpreter binary
+// the way a host service would (write editor.txt, run, collect stdout).
+//
+// Usage: libBench [program-file (editor.txt)] [iterations (200)] [binary (./main)]
+// Build: g++ -std=c++17 -O2 libBench.cpp compilerLib.cpp -o libBench
+#include "compilerLib.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+using namespace std;
+
+static double usSince(chrono::steady_clock::time_point t0){
+    return chrono::duration<double,micro>(chrono::steady_clock::now()-t0).count();
+}
+
+int main(int argc, char** argv){
+    string path=argc>1? argv[1] : "editor.txt";
+    int iters=argc>2? atoi(argv[2]) : 200;
+    string bin=argc>3? argv[3] : "./main";
+
+    ifstream in(path);
+    if (!in) { cerr<<"Cannot open "<<path<<"\n"; return 1; }
+    stringstream ss; ss<<in.rdbuf(); const string src=ss.str();
+
+    // in-process
+    cdl::Context ctx; cdl::Callbacks cb; size_t bytes=0;
+    cb.onOutput=[&](string_view s){ bytes+=s.size(); };
+    auto t0=chrono::steady_clock::now();
+    for (int i=0;i<iters;++i) ctx.evaluate(src,cb);
+    double inproc=usSince(t0)/iters;
+
+    // process spawn: temp dir with editor.txt, stdout captured to a file
+    char dir[]="/tmp/libbenchXXXXXX";
+    if (!mkdtemp(dir)) { cerr<<"mkdtemp failed\n"; return 1; }
+    string absBin=bin;
+    if (absBin[0]!='/') { char cwd[4096]; if(getcwd(cwd,sizeof cwd)) absBin=string(cwd)+"/"+bin; }
+    string editor=string(dir)+"/editor.txt", outPath=string(dir)+"/out.txt";
+    t0=chrono::steady_clock::now();
+    for (int i=0;i<iters;++i) {
+        ofstream(editor)<<src;
+        // run the binary itself in the temp dir (it reads editor.txt from
+        // its working directory): no shell in between
+        pid_t pid=fork(); int st=0;
+        if (pid<0) { cerr<<"fork failed\n"; return 1; }
+        if (pid==0) {
+            int out=open(outPath.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644), null=open("/dev/null",O_WRONLY);
+            if (out<0 || null<0 || dup2(out,1)<0 || dup2(null,2)<0 || chdir(dir)!=0) _exit(127);
+            execl(absBin.c_str(),absBin.c_str(),(char*)nullptr); _exit(127);
+        }
+        waitpid(pid,&st,0);
+        if (!WIFEXITED(st) || WEXITSTATUS(st)==127) { cerr<<"cannot run "<<absBin<<"\n"; return 1; }
+        ifstream o(outPath); stringstream os; os<<o.rdbuf(); bytes+=os.str().size();
+    }
+    double spawned=usSince(t0)/iters;
+    unlink(editor.c_str()); unlink(outPath.c_str()); rmdir(dir);
+
+    cout<<"program: "<<path<<" ("<<src.size()<<" bytes), "<<iters<<" iterations\n";
+    cout<<"in-process evaluate: "<<inproc<<" us/call\n";
+    cout<<"process spawn:       "<<spawned<<" us/call ("<<bin<<")\n";
+    cout<<"speedup: "<<(inproc>0? spawned/inproc:0)<<"x\n";
+    return 0;
+}
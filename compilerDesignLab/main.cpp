@@ -1,122 +1,295 @@
-// interpreter_step5.cpp
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <unordered_map>
-#include <regex>
-#include <cctype>
-#include <cmath>
-#include <iomanip>
-#include <stdexcept>
-
-enum class Type { INT, FLOAT };
-
-struct Env {
-    std::unordered_map<std::string, Type> types;
-    std::unordered_map<std::string, double> values;
-    bool hasVar(const std::string& n) const { return values.find(n) != values.end(); }
-};
-
-struct Parser {
-    std::string s; size_t i=0; Env* env;
-    Parser(const std::string& str, Env* e): s(str), env(e) {}
-    void skip(){while(i<s.size()&&isspace((unsigned char)s[i]))++i;}
-    bool match(char c){skip(); if(i<s.size()&&s[i]==c){++i;return true;}return false;}
-    double parse_number(){
-        skip(); size_t st=i; bool dot=false;
-        if(i<s.size()&&(s[i]=='+'||s[i]=='-'))++i;
-        while(i<s.size()&&(isdigit((unsigned char)s[i])||s[i]=='.')){
-            if(s[i]=='.'){if(dot)break;dot=true;}++i;
-        }
-        return std::stod(s.substr(st,i-st));
-    }
-    std::string parse_identifier(){
-        skip(); if(i>=s.size()||!(isalpha((unsigned char)s[i])||s[i]=='_'))
-            throw std::runtime_error("Expected identifier");
-        size_t st=i++;
-        while(i<s.size()&&(isalnum((unsigned char)s[i])||s[i]=='_'))++i;
-        return s.substr(st,i-st);
-    }
-    double factor(){
-        skip();
-        if(match('(')){double v=expr(); if(!match(')'))throw std::runtime_error("Missing )"); return v;}
-        if(i<s.size()&&(isdigit((unsigned char)s[i])||s[i]=='+'||s[i]=='-'))return parse_number();
-        std::string id=parse_identifier();
-        if(!env->hasVar(id))throw std::runtime_error("Undefined variable: "+id);
-        return env->values[id];
-    }
-    double term(){
-        double v=factor();
-        while(true){skip();
-            if(match('*'))v*=factor();
-            else if(match('/')){double r=factor(); if(fabs(r)<1e-15)throw std::runtime_error("Division by zero"); v/=r;}
-            else break;
-        }return v;
-    }
-    double expr(){
-        double v=term();
-        while(true){skip();
-            if(match('+'))v+=term();
-            else if(match('-'))v-=term();
-            else break;
-        }return v;
-    }
-};
-
-static inline bool is_int_like(double x){return fabs(x-round(x))<1e-9;}
-
-int main(){
-    std::ifstream f("editor.txt");
-    if(!f.is_open()){std::cerr<<"Cannot open editor.txt\n";return 1;}
-    Env env; std::string line;
-
-    std::regex decl(R"(^\s*(integer|float)\s+([A-Za-z_]\w*)\s+te\s+(-?\d+(?:\.\d+)?)\s*$)");
-    std::regex print_re(R"(^\s*dekhao\(\s*(.+)\s*\)\s*$)");
-
-    while(std::getline(f,line)){
-        if(line.empty())continue;
-        std::smatch m;
-        // variable declaration
-        if(std::regex_match(line,m,decl)){
-            std::string type=m[1], var=m[2]; double val=std::stod(m[3]);
-            if(type=="integer"){env.types[var]=Type::INT;env.values[var]=round(val);}
-            else{env.types[var]=Type::FLOAT;env.values[var]=val;}
-            continue;
-        }
-        // print
-        if(std::regex_match(line,m,print_re)){
-            std::string args=m[1];
-            // split by commas not inside quotes
-            bool in_str=false; std::string token;
-            for(size_t i=0;i<=args.size();++i){
-                if(i==args.size()||(!in_str&&args[i]==',')){
-                    std::string part=token; token.clear();
-                    // trim
-                    part=std::regex_replace(part,std::regex(R"(^\s+|\s+$)"),"");
-                    if(!part.empty()){
-                        if(part.size()>=2&&part.front()=='"'&&part.back()=='"'){
-                            std::string text=part.substr(1,part.size()-2);
-                            std::cout<<text;
-                        }else{
-                            try{
-                                Parser p(part,&env);
-                                double val=p.expr();
-                                if(is_int_like(val))std::cout<<(long long)llround(val);
-                                else std::cout<<std::setprecision(12)<<val;
-                            }catch(const std::exception&e){
-                                std::cerr<<"\nError: "<<e.what()<<"\n";
-                            }
-                        }
-                    }
-                    if(i<args.size())std::cout<<" ";
-                }else{
-                    if(args[i]=='"')in_str=!in_str;
-                    token.push_back(args[i]);
-                }
-            }
-            std::cout<<"\n";
-            continue;
-        }
-        std::cerr<<"Syntax Error: "<<line<<"\n";
-    }
-}
+// interpreter_step5.cpp
+#include "interpreter.h"
+#include "tokenStream.h"
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace interp;
+
+// Bounded single-producer/single-consumer ring buffer. push/pop yield while
+// full/empty. The producer samples occupancy on every push for --stats.
+template<class T> class SpscQueue {
+public:
+    explicit SpscQueue(size_t cap): buf(cap+1) {}
+    void push(T v){
+        size_t t=tail.load(std::memory_order_relaxed), n=(t+1)%buf.size();
+        while(n==head.load(std::memory_order_acquire))std::this_thread::yield();
+        buf[t]=std::move(v); tail.store(n,std::memory_order_release);
+        size_t used=(n+buf.size()-head.load(std::memory_order_relaxed))%buf.size();
+        ++pushes; fillSum+=used; if(used>fillMax)fillMax=used;
+    }
+    T pop(){
+        size_t h=head.load(std::memory_order_relaxed);
+        while(h==tail.load(std::memory_order_acquire))std::this_thread::yield();
+        T v=std::move(buf[h]); head.store((h+1)%buf.size(),std::memory_order_release);
+        return v;
+    }
+    size_t capacity() const { return buf.size()-1; }
+    size_t pushes=0, fillSum=0, fillMax=0;
+private:
+    std::vector<T> buf;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
+
+// What a batch wrote to stdout and stderr, kept in write order: one byte
+// string cut into segments tagged with their stream. In the serial loop
+// cerr is tied to cout, so an error shows up in the combined output exactly
+// where it was raised; replay() reproduces that, not just each stream.
+struct Recording {
+    struct Segment { bool err; size_t len; };
+    std::string bytes; std::vector<Segment> segs;
+    void append(bool err, const char* p, size_t n){
+        if(!n)return;
+        if(segs.empty()||segs.back().err!=err)segs.push_back({err,0});
+        segs.back().len+=n; bytes.append(p,n);
+    }
+    void replay(std::ostream& out, std::ostream& err) const {
+        size_t at=0;
+        for(auto& s:segs){
+            if(s.err){out.flush(); err.write(bytes.data()+at,s.len);}
+            else out.write(bytes.data()+at,s.len);
+            at+=s.len;
+        }
+    }
+};
+
+// A pair of ostreams (out, err) that append to one Recording.
+class Recorder {
+    struct Buf: std::streambuf {
+        Recording* rec; bool err;
+        Buf(Recording* r, bool e): rec(r), err(e) {}
+        int_type overflow(int_type c) override {
+            if(c!=traits_type::eof()){char ch=(char)c; rec->append(err,&ch,1);}
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char* p, std::streamsize n) override { rec->append(err,p,(size_t)n); return n; }
+    };
+    Recording rec; Buf outBuf{&rec,false}, errBuf{&rec,true};
+public:
+    std::ostream out{&outBuf}, err{&errBuf};
+    Recording take(){ Recording r=std::move(rec); rec=Recording(); return r; }
+};
+
+// Output of one evaluated batch; end marks the last chunk.
+struct Chunk { Recording rec; bool end=false; };
+
+static void print_stats(const char* name, size_t cap, size_t pushes, size_t sum, size_t mx){
+    std::cerr<<"queue "<<name<<": "<<pushes<<" batches, avg fill "
+             <<std::setprecision(3)<<(pushes?double(sum)/pushes:0.0)<<"/"<<cap<<", max "<<mx<<"\n";
+}
+
+// reader -> classify -> evaluate (owns Env) -> output (this thread).
+// Lines travel in batches; an empty batch ends the stream. Output is
+// recorded per batch and replayed in write order, so each stream and their
+// interleaving match the serial loop.
+static void run_pipelined(std::istream& f, bool stats, Profiler* prof){
+    const size_t BATCH=512, DEPTH=64;
+    SpscQueue<std::vector<std::string>> raw(DEPTH);
+    SpscQueue<std::vector<Line>> parsed(DEPTH);
+    SpscQueue<Chunk> done(DEPTH);
+
+    std::thread reader([&]{
+        std::vector<std::string> b; b.reserve(BATCH); std::string line;
+        while(std::getline(f,line)){
+            b.push_back(std::move(line));
+            if(b.size()==BATCH){raw.push(std::move(b));b.clear();b.reserve(BATCH);}
+        }
+        if(!b.empty())raw.push(std::move(b));
+        raw.push({});
+    });
+    std::thread parser([&]{
+        size_t no=0;
+        for(;;){
+            auto b=raw.pop(); std::vector<Line> out; out.reserve(b.size());
+            for(auto& s:b){out.push_back(classify(s,++no)); if(prof)out.back().src=std::move(s);}
+            bool last=b.empty(); parsed.push(std::move(out));
+            if(last)break;
+        }
+    });
+    std::thread evaluator([&]{
+        Env env; Recorder r;
+        for(;;){
+            auto b=parsed.pop();
+            if(!prof)for(auto& l:b)run(l,env,r.out,r.err);
+            else for(auto& l:b){
+                auto t0=Profiler::clock::now(); run(l,env,r.out,r.err,prof);
+                prof->line(l,l.src,Profiler::since(t0));
+            }
+            Chunk c; c.rec=r.take(); c.end=b.empty();
+            done.push(std::move(c));
+            if(b.empty())break;
+        }
+    });
+    for(;;){
+        Chunk c=done.pop();
+        c.rec.replay(std::cout,std::cerr);
+        if(c.end)break;
+    }
+    reader.join(); parser.join(); evaluator.join();
+    if(stats){
+        print_stats("read->parse",raw.capacity(),raw.pushes,raw.fillSum,raw.fillMax);
+        print_stats("parse->eval",parsed.capacity(),parsed.pushes,parsed.fillSum,parsed.fillMax);
+        print_stats("eval->out",done.capacity(),done.pushes,done.fillSum,done.fillMax);
+    }
+}
+
+// Fixed set of worker threads running one parallel loop at a time. The
+// caller helps and parallelFor returns once every index is done and no
+// worker is still inside the loop, so fn may reference the caller's stack.
+// A worker copies fn and count under the lock and only joins a loop that
+// still has indices left, so one that wakes late never mixes two loops.
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned n){ for(unsigned t=0;t<n;++t)threads.emplace_back([this]{work();}); }
+    ~WorkerPool(){
+        {std::lock_guard<std::mutex> g(m);stop=true;}
+        wake.notify_all();
+        for(auto& t:threads)t.join();
+    }
+    void parallelFor(size_t n, const std::function<void(size_t)>& f){
+        {std::lock_guard<std::mutex> g(m); fn=&f; count=n; next=0; left=n; ++gen;}
+        wake.notify_all();
+        drain(&f,n);
+        std::unique_lock<std::mutex> l(m);
+        done.wait(l,[&]{return left==0&&active==0;});
+    }
+private:
+    std::vector<std::thread> threads;
+    std::mutex m; std::condition_variable wake, done;
+    const std::function<void(size_t)>* fn=nullptr;
+    size_t count=0, left=0; unsigned active=0; unsigned long gen=0; bool stop=false;
+    std::atomic<size_t> next{0};
+
+    void drain(const std::function<void(size_t)>* f, size_t n){
+        size_t i, finished=0;
+        while((i=next.fetch_add(1))<n){(*f)(i);++finished;}
+        std::lock_guard<std::mutex> g(m); left-=finished;
+    }
+    void work(){
+        unsigned long seen=0;
+        for(;;){
+            const std::function<void(size_t)>* f; size_t n;
+            {
+                std::unique_lock<std::mutex> l(m);
+                wake.wait(l,[&]{return stop||gen!=seen;});
+                if(stop)return;
+                seen=gen;
+                if(left==0)continue;
+                f=fn; n=count; ++active;
+            }
+            drain(f,n);
+            {std::lock_guard<std::mutex> g(m); --active;}
+            done.notify_all();
+        }
+    }
+};
+
+// Lines are read in batches and classified in parallel (classify never
+// touches Env). Declarations run in order on this thread; every run of
+// non-declaration lines between them only reads Env, so its lines are
+// evaluated on the pool in chunks, each into its own Recording, and the
+// recordings are replayed in source order: stdout, stderr and their
+// interleaving match the serial loop.
+static void run_parallel(std::istream& f, unsigned threads){
+    const size_t BATCH=1<<16, CHUNK=64, MIN_RUN=2*CHUNK;
+    WorkerPool pool(threads>1?threads-1:0);
+    Env env; size_t no=0;
+    std::vector<std::string> raw; std::vector<Line> lines;
+    std::vector<Recording> recs;
+    for(;;){
+        raw.clear(); std::string line;
+        while(raw.size()<BATCH&&std::getline(f,line))raw.push_back(std::move(line));
+        if(raw.empty())break;
+        lines.assign(raw.size(),Line());
+        size_t chunks=(raw.size()+CHUNK-1)/CHUNK;
+        pool.parallelFor(chunks,[&](size_t c){
+            for(size_t k=c*CHUNK;k<std::min(raw.size(),(c+1)*CHUNK);++k)lines[k]=classify(raw[k],no+k+1);
+        });
+        no+=raw.size();
+
+        for(size_t i=0;i<lines.size();){
+            if(lines[i].kind==Line::DECL){run(lines[i++],env,std::cout,std::cerr);continue;}
+            size_t j=i; while(j<lines.size()&&lines[j].kind!=Line::DECL)++j;
+            if(j-i<MIN_RUN){for(;i<j;++i)run(lines[i],env,std::cout,std::cerr);continue;}
+            size_t n=(j-i+CHUNK-1)/CHUNK;
+            recs.assign(n,Recording());
+            pool.parallelFor(n,[&](size_t c){
+                Recorder r;
+                for(size_t k=i+c*CHUNK;k<std::min(j,i+(c+1)*CHUNK);++k)run(lines[k],env,r.out,r.err);
+                recs[c]=r.take();
+            });
+            for(auto& rec:recs)rec.replay(std::cout,std::cerr);
+            i=j;
+        }
+    }
+}
+
+// --tokens: rebuild the program from a token file (tokenizetion --bin)
+// instead of reading editor.txt. Tokens that were apart in the source are
+// joined by one space and adjacent ones directly (so "-5" and "2.5" stay
+// whole), which gives classify() the same statements; only whitespace runs
+// are normalized, as seen in a "Syntax Error:" echo or a blank-only line.
+static bool load_tokens(const std::string& path, std::string& text, std::string& err){
+    toks::Reader in;
+    if(!in.open(path,err))return false;
+    for(uint64_t l=0;l<in.lines();++l){
+        uint64_t end=0;
+        for(uint64_t k=in.first(l);k<in.first(l+1);++k){
+            const toks::Record& r=in.token(k);
+            if(k>in.first(l)&&r.offset!=end)text+=' ';
+            text+=in.text(r); end=r.offset+r.length;
+        }
+        text+='\n';
+    }
+    return true;
+}
+
+int main(int argc,char** argv){
+    // --pipeline : run reader/parser/evaluator/output on separate threads
+    // --stats    : with --pipeline, report queue occupancy on stderr
+    // --profile  : write profile.txt and profile.folded (per line / argument)
+    // --parallel : evaluate runs of dekhao lines on --threads N workers
+    // --tokens F : run the program stored in token file F
+    bool pipeline=false, stats=false, parallel=false; std::unique_ptr<Profiler> prof;
+    std::string tokenFile;
+    unsigned threads=std::max(1u,std::thread::hardware_concurrency());
+    for(int a=1;a<argc;++a){
+        std::string arg=argv[a];
+        if(arg=="--pipeline")pipeline=true;
+        else if(arg=="--stats")stats=true;
+        else if(arg=="--profile")prof=std::make_unique<Profiler>();
+        else if(arg=="--parallel")parallel=true;
+        else if(arg=="--threads"&&a+1<argc)threads=std::max(1,std::stoi(argv[++a]));
+        else if(arg=="--tokens"&&a+1<argc)tokenFile=argv[++a];
+        else{std::cerr<<"Unknown option: "<<arg<<"\n";return 1;}
+    }
+    std::ifstream file; std::istringstream fromTokens;
+    std::istream& f=tokenFile.empty()?static_cast<std::istream&>(file):fromTokens;
+    if(!tokenFile.empty()){
+        std::string text,err;
+        if(!load_tokens(tokenFile,text,err)){std::cerr<<"Error: "<<err<<"\n";return 1;}
+        fromTokens.str(std::move(text));
+    }else{
+        file.open("editor.txt");
+        if(!file.is_open()){std::cerr<<"Cannot open editor.txt\n";return 1;}
+    }
+    if(parallel&&(pipeline||prof)){std::cerr<<"--parallel cannot be combined with --pipeline or --profile\n";return 1;}
+    if(parallel)run_parallel(f,threads);
+    else if(pipeline)run_pipelined(f,stats,prof.get());
+    else{
+        Env env; std::string line; size_t no=0;
+        if(!prof)while(std::getline(f,line))run(classify(line,++no),env,std::cout,std::cerr);
+        else while(std::getline(f,line)){
+            auto t0=Profiler::clock::now();
+            Line l=classify(line,++no); run(l,env,std::cout,std::cerr,prof.get());
+            prof->line(l,line,Profiler::since(t0));
+        }
+    }
+    if(prof)prof->write("profile.txt","profile.folded","editor.txt");
+}
@@ -0,0 +1,206 @@
+// Benchmark: the iterative operator-precedence expression parsers
+// (interp::Parser::expr in interpreter.h, sema::Parser in semantic.h) against
+// the recursive-descent expr/term/factor parsers they replaced, kept below as
+// reference copies. Every workload checks that both give the same value
+// (interp) or the same pool of nodes (sema, with and without hash-consing).
+// Each side runs in its own forked child (same fresh heap for both), so a
+// stack overflow in the recursive parser is reported instead of ending the
+// benchmark.
+//
+// Usage: parserBench [terms (1000000)] [depth (100000)] [reps (3)]
+// Build: g++ -std=c++17 -O2 parserBench.cpp -o parserBench
+#include "interpreter.h"
+#include "semantic.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+using namespace std;
+
+// ===== Recursive reference parsers =====
+struct RecursiveEval {
+    interp::Parser p;
+    RecursiveEval(const string& s, interp::Env* e): p(s,e) {}
+    double factor(){
+        p.skip();
+        if(p.match('(')){double v=expr(); if(!p.match(')'))throw runtime_error("Missing )"); return v;}
+        return p.factor();
+    }
+    double term(){
+        double v=factor();
+        while(true){p.skip();
+            if(p.match('*'))v*=factor();
+            else if(p.match('/')){double r=factor(); if(fabs(r)<1e-15)throw runtime_error("Division by zero"); v/=r;}
+            else break;
+        }return v;
+    }
+    double expr(){
+        double v=term();
+        while(true){p.skip();
+            if(p.match('+'))v+=term();
+            else if(p.match('-'))v-=term();
+            else break;
+        }return v;
+    }
+};
+
+struct RecursiveSema {
+    const vector<sema::Token>& toks; sema::ExprPool& pool; size_t i=2;   // after "dekhao ("
+    using T=sema::TokType;
+    bool check(T t) const { return toks[i].type==t; }
+    sema::Expr* parseExpr(){
+        auto left=parseTerm(); if(!left) return nullptr;
+        while(check(T::PLUS)||check(T::MINUS)){
+            string op=toks[i++].lexeme;
+            auto right=parseTerm(); if(!right) return nullptr;
+            left=pool.binary(op,left,right,toks[i].line);
+        }
+        return left;
+    }
+    sema::Expr* parseTerm(){
+        auto left=parseFactor(); if(!left) return nullptr;
+        while(check(T::STAR)||check(T::SLASH)){
+            string op=toks[i++].lexeme;
+            auto right=parseFactor(); if(!right) return nullptr;
+            left=pool.binary(op,left,right,toks[i].line);
+        }
+        return left;
+    }
+    sema::Expr* parseFactor(){
+        auto& t=toks[i];
+        if(check(T::IDENT)){ ++i; return pool.ident(t.lexeme,t.line); }
+        if(check(T::NUMBER)){ ++i; return pool.number(stoi(t.lexeme),t.line); }
+        if(check(T::LPAREN)){ ++i; auto e=parseExpr(); if(!e || !check(T::RPAREN)) return nullptr; ++i; return e; }
+        return nullptr;
+    }
+};
+
+// ===== Workloads =====
+static string flatSum(long terms){            // x * 2 + 7 - y / 3 + ...
+    string s; const char* atoms[]={"x * 2","7","y / 3","(x - 1) * y","5"};
+    for (long k=0;k<terms;++k){ if(k) s+= k%3? " + " : " - "; s+=atoms[k%5]; }
+    return s;
+}
+static string nested(long depth){ return string(depth,'(')+"x"+string(depth,')'); }
+static string rightNested(long depth){        // x+(x+(x+ ... 1))
+    string s; for (long k=0;k<depth;++k) s+="x+("; s+="1"; return s+string(depth,')');
+}
+
+// Shape of a pool, for comparing the two sema parsers node by node
+static string poolShape(const sema::ExprPool& pool){
+    string out;
+    for (size_t k=0;k<pool.size();++k) {
+        const sema::Expr* e=pool.at(k);
+        if (auto n=dynamic_cast<const sema::Number*>(e)) out+="N"+to_string(n->value);
+        else if (auto id=dynamic_cast<const sema::Ident*>(e)) out+="I"+id->name;
+        else if (auto b=dynamic_cast<const sema::Binary*>(e)) out+="B"+b->op+to_string(b->left->id)+","+to_string(b->right->id);
+        out+=';';
+    }
+    return out;
+}
+
+static double msSince(chrono::steady_clock::time_point t0){
+    return chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+}
+
+// f(ms) runs one workload, stores the time of its parse in ms and returns a
+// checksum of the result. Best of reps runs.
+template<class F>
+static pair<double,string> best(int reps, F f){
+    double ms=0, top=1e300; string sum;
+    for (int r=0;r<reps;++r){ sum=f(ms); top=min(top,ms); }
+    return {top,sum};
+}
+
+// best() in a child process; ms<0 if the child died (stack overflow)
+template<class F>
+static pair<double,string> inChild(int reps, F f){
+    int fd[2]; if (pipe(fd)!=0) return {-1,""};
+    pid_t pid=fork();
+    if (pid==0) {
+        close(fd[0]);
+        auto r=best(reps,f); string msg=to_string(r.first)+"\n"+r.second;
+        if (write(fd[1],msg.data(),msg.size())<0) _exit(1);
+        _exit(0);
+    }
+    close(fd[1]);
+    string msg; char buf[1<<16]; ssize_t n;
+    while ((n=read(fd[0],buf,sizeof buf))>0) msg.append(buf,n);
+    close(fd[0]);
+    int st=0; waitpid(pid,&st,0);
+    if (!WIFEXITED(st) || WEXITSTATUS(st)!=0) return {-1,""};
+    auto nl=msg.find('\n');
+    return {stod(msg.substr(0,nl)), msg.substr(nl+1)};
+}
+
+static int failures=0;
+static void report(const string& name, pair<double,string> rec, pair<double,string> it){
+    printf("%-28s", name.c_str());
+    if (rec.first<0) printf("%14s", "stack overflow"); else printf("%11.2f ms", rec.first);
+    if (it.first<0) printf("%14s", "stack overflow"); else printf("%11.2f ms", it.first);
+    if (rec.first<0 || it.first<0) printf("      -  ");
+    else { printf("  %6.2fx", rec.first/it.first); if (rec.second!=it.second) { printf("  MISMATCH"); ++failures; } }
+    printf("\n");
+}
+
+int main(int argc, char** argv){
+    long terms=argc>1? atol(argv[1]) : 1000000;
+    long depth=argc>2? atol(argv[2]) : 100000;
+    int reps=argc>3? atoi(argv[3]) : 3;
+
+    interp::Env env;
+    env.types["x"]=interp::Type::INT; env.values["x"]=3;
+    env.types["y"]=interp::Type::FLOAT; env.values["y"]=1.5;
+
+    struct Case { string name, text; };
+    vector<Case> cases={
+        {"flat, "+to_string(terms)+" terms", flatSum(terms)},
+        {"flat, 1000 terms x1000", ""},
+        {"parens, depth "+to_string(depth), nested(depth)},
+        {"x+(..), depth "+to_string(depth), rightNested(depth)},
+    };
+    const string small=flatSum(1000);
+    auto value=[](double v){ char b[40]; snprintf(b,sizeof b,"%a",v); return string(b); };
+
+    printf("%-28s%14s%14s%9s\n","interp (evaluate)","recursive","iterative","speedup");
+    for (auto& c: cases) {
+        const string& text=c.text.empty()? small : c.text;
+        int times=c.text.empty()? 1000 : 1;
+        auto run=[&](auto eval){
+            return [&,eval](double& ms){
+                double v=0; auto t0=chrono::steady_clock::now();
+                for (int k=0;k<times;++k) v+=eval(text);
+                ms=msSince(t0); return value(v);
+            };
+        };
+        report(c.name, inChild(reps,run([&](const string& t){ return RecursiveEval(t,&env).expr(); })),
+                       inChild(reps,run([&](const string& t){ return interp::Parser(t,&env).expr(); })));
+    }
+
+    for (bool hc: {false,true}) {
+        printf("\n%-28s%14s%14s%9s\n", hc? "sema (parse, hash-consed)":"sema (parse)","recursive","iterative","speedup");
+        for (auto& c: cases) {
+            int times=c.text.empty()? 1000 : 1;
+            const auto toks=sema::Lexer::lexLine("dekhao("+(c.text.empty()? small : c.text)+")",1).tokens;
+            auto rec=[&](double& ms){
+                sema::ExprPool pool; pool.hashCons=hc; bool ok=true;
+                auto t0=chrono::steady_clock::now();
+                for (int k=0;k<times;++k){ RecursiveSema P{toks,pool}; ok=ok&&P.parseExpr(); }
+                ms=msSince(t0); return ok? poolShape(pool) : "error";
+            };
+            auto it=[&](double& ms){
+                sema::ExprPool pool; pool.hashCons=hc; bool ok=true; string err;
+                auto t0=chrono::steady_clock::now();
+                for (int k=0;k<times;++k){ sema::Parser P(toks,pool); ok=ok&&P.parseStatement(err); }
+                ms=msSince(t0); return ok? poolShape(pool) : "error";
+            };
+            report(c.name, inChild(reps,rec), inChild(reps,it));
+        }
+    }
+    if (failures) { printf("%d mismatch(es)\n", failures); return 2; }
+    return 0;
+}
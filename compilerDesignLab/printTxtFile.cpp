@@ -1,36 +1,245 @@
 #include <iostream>   // For input and output (cout, cin, cerr)
-#include <fstream>    // For file handling (ifstream)
+#include <fstream>    // For reading/writing the line index file
 #include <string>     // For using the string data type
+#include <vector>     // For the line index checkpoints
+#include <cstring>    // For memchr
+#include <cstdint>    // For fixed-size integers in the index file
+#include <cstdlib>    // For strtoull
+#include <fcntl.h>    // For open()
+#include <unistd.h>   // For read(), write(), close()
+#include <sys/stat.h> // For fstat() (file size and modification time)
+#ifdef __linux__
+#include <sys/sendfile.h>  // For sendfile(): kernel-side copy to stdout
+#endif
 using namespace std;
 
-int main() {
-    string filename;  // To store the file name entered by the user
+// Usage:
+//   printTxtFile                     asks for the file name and prints it
+//   printTxtFile FILE                prints FILE
+//   printTxtFile FILE --lines N M    prints only lines N..M (1-based, inclusive)
+//
+// Whole files are copied to stdout without going through a line loop:
+// on Linux with sendfile() (no user-space copy, works when stdout is a file
+// or a pipe), otherwise with large read()/write() blocks.
+//
+// For --lines a sparse line index is stored next to the file as FILE.lineidx
+// (the offset of every 1024th line). It is built once, reused while the file
+// size, inode and modification time (to the nanosecond) match, and lets a
+// range in the middle of a huge file start after scanning at most 1023 lines.
 
-    // Ask the user to enter the name of the file
-    cout << "Enter the file name: ";
-    cin >> filename;
+const uint64_t STRIDE = 1024;          // lines between index checkpoints
+const size_t BUF_SIZE = 1 << 20;       // 1 MiB read/write blocks
+const uint32_t INDEX_VERSION = 2;      // 2: inode and nanosecond mtime
+
+// Write all n bytes to stdout, retrying on short writes
+bool writeAll(const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(1, p, n);
+        if (w <= 0) return false;
+        p += w; n -= (size_t)w;
+    }
+    return true;
+}
+
+// Copy bytes [from, to) of the open file to stdout
+bool copyRange(int fd, uint64_t from, uint64_t to) {
+#ifdef __linux__
+    // Let the kernel move the data; falls back below if stdout does not support it
+    off_t off = (off_t)from;
+    while ((uint64_t)off < to) {
+        ssize_t n = sendfile(1, fd, &off, (size_t)min<uint64_t>(to - off, 1u << 30));
+        if (n <= 0) break;
+    }
+    if ((uint64_t)off >= to) return true;
+    from = (uint64_t)off;
+#endif
+    vector<char> buf(BUF_SIZE);
+    if (lseek(fd, (off_t)from, SEEK_SET) < 0) return false;
+    while (from < to) {
+        ssize_t n = read(fd, buf.data(), (size_t)min<uint64_t>(to - from, buf.size()));
+        if (n <= 0) return false;
+        if (!writeAll(buf.data(), (size_t)n)) return false;
+        from += (uint64_t)n;
+    }
+    return true;
+}
+
+// Sparse line index: marks[k] is the byte offset where line k*STRIDE+1 starts
+struct LineIndex {
+    uint64_t fileSize = 0;
+    uint64_t inode = 0;
+    int64_t mtimeSec = 0, mtimeNsec = 0;
+    uint64_t lines = 0;            // a last line without '\n' still counts
+    vector<uint64_t> marks;
+};
+
+// Scan the whole file once and record every STRIDE-th line start
+// Identity of the file version an index describes. st_mtime alone has
+// one-second resolution: a same-size edit within that second would reuse
+// stale offsets.
+void stamp(LineIndex& idx, const struct stat& st) {
+    idx.fileSize = (uint64_t)st.st_size;
+    idx.inode = (uint64_t)st.st_ino;
+#ifdef __APPLE__
+    idx.mtimeSec = (int64_t)st.st_mtimespec.tv_sec;
+    idx.mtimeNsec = (int64_t)st.st_mtimespec.tv_nsec;
+#else
+    idx.mtimeSec = (int64_t)st.st_mtim.tv_sec;
+    idx.mtimeNsec = (int64_t)st.st_mtim.tv_nsec;
+#endif
+}
+
+LineIndex buildIndex(int fd, const struct stat& st) {
+    LineIndex idx;
+    stamp(idx, st);
+    idx.marks.push_back(0);
+
+    vector<char> buf(BUF_SIZE);
+    uint64_t pos = 0, newlines = 0;
+    char last = '\n';
+    lseek(fd, 0, SEEK_SET);
+    ssize_t n;
+    while ((n = read(fd, buf.data(), buf.size())) > 0) {
+        const char* p = buf.data();
+        const char* end = p + n;
+        while ((p = (const char*)memchr(p, '\n', end - p)) != nullptr) {
+            ++p; ++newlines;
+            if (newlines % STRIDE == 0) idx.marks.push_back(pos + (uint64_t)(p - buf.data()));
+        }
+        last = buf[n - 1];
+        pos += (uint64_t)n;
+    }
+    idx.lines = newlines + (pos > 0 && last != '\n' ? 1 : 0);
+    // a checkpoint exactly at end of file is not the start of a line
+    if (idx.marks.size() > 1 && idx.marks.back() >= idx.fileSize) idx.marks.pop_back();
+    return idx;
+}
+
+// Index file layout: "LIDX" | u32 version | u64 size | u64 inode | i64 mtime sec | i64 mtime nsec
+//                   | u64 lines | u64 count | u64 marks[count]
+bool loadIndex(const string& path, const struct stat& st, LineIndex& idx) {
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    char magic[4]; uint32_t version = 0; uint64_t count = 0;
+    in.read(magic, 4);
+    in.read((char*)&version, sizeof version);
+    in.read((char*)&idx.fileSize, sizeof idx.fileSize);
+    in.read((char*)&idx.inode, sizeof idx.inode);
+    in.read((char*)&idx.mtimeSec, sizeof idx.mtimeSec);
+    in.read((char*)&idx.mtimeNsec, sizeof idx.mtimeNsec);
+    in.read((char*)&idx.lines, sizeof idx.lines);
+    in.read((char*)&count, sizeof count);
+    if (!in || memcmp(magic, "LIDX", 4) != 0 || version != INDEX_VERSION) return false;
+    // stale if the text file changed (or was replaced) since the index was written
+    LineIndex now; stamp(now, st);
+    if (idx.fileSize != now.fileSize || idx.inode != now.inode ||
+        idx.mtimeSec != now.mtimeSec || idx.mtimeNsec != now.mtimeNsec) return false;
+    if (count == 0 || count > idx.fileSize / STRIDE + 1) return false;
+    idx.marks.resize(count);
+    in.read((char*)idx.marks.data(), count * sizeof(uint64_t));
+    return (bool)in;
+}
+
+void saveIndex(const string& path, const LineIndex& idx) {
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return;  // read-only directory: keep using the in-memory index
+    uint32_t version = INDEX_VERSION; uint64_t count = idx.marks.size();
+    out.write("LIDX", 4);
+    out.write((const char*)&version, sizeof version);
+    out.write((const char*)&idx.fileSize, sizeof idx.fileSize);
+    out.write((const char*)&idx.inode, sizeof idx.inode);
+    out.write((const char*)&idx.mtimeSec, sizeof idx.mtimeSec);
+    out.write((const char*)&idx.mtimeNsec, sizeof idx.mtimeNsec);
+    out.write((const char*)&idx.lines, sizeof idx.lines);
+    out.write((const char*)&count, sizeof count);
+    out.write((const char*)idx.marks.data(), count * sizeof(uint64_t));
+}
+
+// Byte offset where line n (1-based) starts; lines+1 means end of file
+uint64_t lineStart(int fd, const LineIndex& idx, uint64_t n) {
+    if (n > idx.lines) return idx.fileSize;
+    uint64_t k = (n - 1) / STRIDE;
+    uint64_t skip = (n - 1) % STRIDE;      // newlines still to pass after the checkpoint
+    uint64_t pos = idx.marks[k];
+    vector<char> buf(64 * 1024);
+    lseek(fd, (off_t)pos, SEEK_SET);
+    while (skip > 0) {
+        ssize_t got = read(fd, buf.data(), buf.size());
+        if (got <= 0) return idx.fileSize;
+        const char* p = buf.data();
+        const char* end = p + got;
+        while (skip > 0 && (p = (const char*)memchr(p, '\n', end - p)) != nullptr) { ++p; --skip; }
+        if (skip == 0) return pos + (uint64_t)(p - buf.data());
+        pos += (uint64_t)got;
+    }
+    return pos;
+}
+
+int main(int argc, char* argv[]) {
+    string filename;  // To store the file name
+    uint64_t first = 0, last = 0;  // --lines range, 0 = whole file
+
+    if (argc > 1) {
+        // File name (and optional range) from the command line
+        filename = argv[1];
+        if (argc == 5 && string(argv[2]) == "--lines") {
+            first = strtoull(argv[3], nullptr, 10);
+            last = strtoull(argv[4], nullptr, 10);
+            if (first == 0 || last < first) {
+                cerr << "Error: --lines needs 1 <= N <= M." << endl;
+                return 1;
+            }
+        } else if (argc != 2) {
+            cerr << "Usage: " << argv[0] << " [FILE [--lines N M]]" << endl;
+            return 1;
+        }
+    } else {
+        // Ask the user to enter the name of the file
+        cout << "Enter the file name: ";
+        cin >> filename;
+    }
 
     // Open the given file for reading
-    ifstream file(filename);
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
 
     // Check if the file failed to open
-    if (!file) {
+    if (fd < 0 || fstat(fd, &st) != 0) {
         cerr << "Error: Could not open the file." << endl;
         return 1;  // Exit the program with an error code
     }
 
-    string line;  // To store each line from the file
+    // Print a header before showing file contents (flushed before raw writes)
+    cout << "\n--- File Content ---\n" << flush;
 
-    // Print a header before showing file contents
-    cout << "\n--- File Content ---\n";
+    uint64_t from = 0, to = (uint64_t)st.st_size;
+    if (first > 0) {
+        // Reuse FILE.lineidx if it is still valid, otherwise build and store it
+        string idxPath = filename + ".lineidx";
+        LineIndex idx;
+        if (!loadIndex(idxPath, st, idx)) {
+            idx = buildIndex(fd, st);
+            saveIndex(idxPath, idx);
+        }
+        from = lineStart(fd, idx, first);
+        to = lineStart(fd, idx, min(last, idx.lines) + 1);
+    }
 
-    // Read the file line by line until the end of file (EOF)
-    while (getline(file, line)) {
-        cout << line << endl;  // Display each line on the screen
+    bool ok = copyRange(fd, from, to);
+
+    // Like getline + endl, always finish with a newline
+    if (ok && to > from) {
+        char end = 0;
+        if (pread(fd, &end, 1, (off_t)(to - 1)) == 1 && end != '\n') ok = writeAll("\n", 1);
     }
 
     // Close the file after reading
-    file.close();
+    close(fd);
+
+    if (!ok) {
+        cerr << "Error: Could not write the file to standard output." << endl;
+        return 1;
+    }
 
     // End of program
     return 0;
@@ -0,0 +1,219 @@
+// Differential + scaling harness for the three interpreter front ends:
+//   main.cpp (editor.txt), dataTypeAssignAndPrint.cpp (editor.txt) and
+//   semantic.cpp (input.txt).
+// For every size it generates one program in their common integer subset
+// (non-negative integer decls, single-expression dekhao with + - * and
+// parentheses, values small enough to be exact in double), runs each binary
+// on it and records throughput, peak RSS and an output checksum. It then
+//   - checks all three agree on the sequence of printed values
+//     (semantic.cpp's are read from its "Print(dekhao) ... expr.const=" lines),
+//   - compares against a stored baseline file with regression thresholds.
+//
+// Usage: scalingHarness [--main BIN] [--dtap BIN] [--semantic BIN]
+//                       [--min BYTES] [--max BYTES] [--semantic-max BYTES]
+//                       [--baseline FILE] [--update-baseline]
+//                       [--max-slowdown PCT] [--max-rss-growth PCT]
+// Sizes go from --min (1K) to --max (64M) in steps of x16; suffixes K/M/G work.
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <iomanip>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+using namespace std;
+
+// ===== Input generation =====
+struct Rng {
+    uint64_t s;
+    explicit Rng(uint64_t seed):s(seed){}
+    uint32_t next(){ s=s*6364136223846793005ULL+1442695040888963407ULL; return (uint32_t)(s>>33); }
+    uint32_t below(uint32_t n){ return next()%n; }
+};
+
+// term := atom | atom * atom | (atom + atom) * atom ;  expr := term {(+|-) term}
+static void genExpr(Rng& r, int vars, string& out){
+    auto atom=[&]{ if (vars && r.below(3)) out+="v"+to_string(r.below(vars)); else out+=to_string(r.below(1000)); };
+    int terms=1+r.below(6);
+    for (int t=0;t<terms;++t) {
+        if (t) out+= r.below(2)? " + " : " - ";
+        switch (r.below(3)) {
+            case 0: atom(); break;
+            case 1: atom(); out+=" * "; atom(); break;
+            default: out+="("; atom(); out+=" + "; atom(); out+=") * "; atom(); break;
+        }
+    }
+}
+
+static bool generate(const string& path, uint64_t bytes){
+    FILE* f=fopen(path.c_str(),"wb"); if(!f) return false;
+    static char iobuf[1<<20]; setvbuf(f,iobuf,_IOFBF,sizeof iobuf);
+    Rng r(bytes*2654435761ULL+17);
+    uint64_t written=0; int vars=0; string line;
+    while (written<bytes) {
+        line.clear();
+        if (vars==0 || r.below(20)==0) { line="integer v"+to_string(vars++)+" te "+to_string(r.below(1000)); }
+        else { line="dekhao("; genExpr(r,vars,line); line+=")"; }
+        line+='\n'; fwrite(line.data(),1,line.size(),f); written+=line.size();
+    }
+    return fclose(f)==0;
+}
+
+// ===== Running a front end =====
+struct RunResult {
+    bool ok=false; int status=0;
+    double seconds=0; long rssKb=0;
+    uint64_t outHash=0;            // FNV-1a of raw stdout
+    uint64_t valueHash=0;          // FNV-1a of the printed value sequence
+    uint64_t values=0;
+};
+
+static void fnv(uint64_t& h, const char* p, size_t n){
+    for (size_t i=0;i<n;++i){ h^=(unsigned char)p[i]; h*=1099511628211ULL; }
+}
+
+// Values are one per stdout line for main/dtap; for semantic they follow
+// "expr.const=" on "Print(dekhao)" lines of the annotated tree.
+static void takeValue(RunResult& R, const string& line, bool semantic){
+    string v;
+    if (!semantic) v=line;
+    else {
+        if (line.find("Print(dekhao)")==string::npos) return;
+        auto p=line.find("expr.const="); if (p==string::npos) v="?"; else v=line.substr(p+11);
+    }
+    fnv(R.valueHash,v.data(),v.size()); fnv(R.valueHash,"\n",1); ++R.values;
+}
+
+static RunResult runOne(const string& bin, const string& dir, bool semantic){
+    RunResult R; R.outHash=R.valueHash=1469598103934665603ULL;
+    int fd[2]; if (pipe(fd)!=0) return R;
+    auto t0=chrono::steady_clock::now();
+    pid_t pid=fork();
+    if (pid==0) {
+        if (chdir(dir.c_str())!=0) _exit(127);
+        dup2(fd[1],1); close(fd[0]); close(fd[1]);
+        int devnull=open("/dev/null",O_WRONLY); if(devnull>=0) dup2(devnull,2);
+        execl(bin.c_str(),bin.c_str(),(char*)nullptr); _exit(127);
+    }
+    close(fd[1]);
+    static char buf[1<<16]; string line; ssize_t n;
+    while ((n=read(fd[0],buf,sizeof buf))>0) {
+        fnv(R.outHash,buf,n);
+        for (ssize_t i=0;i<n;++i) {
+            if (buf[i]=='\n') { takeValue(R,line,semantic); line.clear(); }
+            else line.push_back(buf[i]);
+        }
+    }
+    close(fd[0]);
+    int st=0; struct rusage ru{};
+    wait4(pid,&st,0,&ru);
+    R.seconds=chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+#ifdef __APPLE__
+    R.rssKb=ru.ru_maxrss/1024;
+#else
+    R.rssKb=ru.ru_maxrss;
+#endif
+    R.status=st; R.ok=WIFEXITED(st)&&WEXITSTATUS(st)==0;
+    return R;
+}
+
+// ===== Baselines =====
+// One line per (front end, size): name bytes MB/s rssKb outHash valueHash
+struct Baseline { double mbps=0; long rssKb=0; uint64_t outHash=0, valueHash=0; };
+
+static map<string,Baseline> loadBaseline(const string& path){
+    map<string,Baseline> m; ifstream in(path); string name; uint64_t bytes;
+    Baseline b;
+    while (in>>name>>bytes>>b.mbps>>b.rssKb>>hex>>b.outHash>>b.valueHash>>dec) m[name+"@"+to_string(bytes)]=b;
+    return m;
+}
+
+static uint64_t parseSize(const string& s){
+    char* end=nullptr; double v=strtod(s.c_str(),&end);
+    switch (end&&*end? toupper(*end):0) { case 'K': v*=1024; break; case 'M': v*=1<<20; break; case 'G': v*=1<<30; break; }
+    return (uint64_t)v;
+}
+
+int main(int argc, char** argv){
+    string bins[3]={"./main","./dataTypeAssignAndPrint","./semantic"};
+    const char* names[3]={"main","dtap","semantic"};
+    uint64_t minSize=1<<10, maxSize=64ULL<<20, semMax=16ULL<<20;
+    string baselinePath="scaling_baseline.txt"; bool update=false;
+    double maxSlowdown=20, maxRssGrowth=20, minTimed=0.2;
+    for (int a=1;a<argc;++a) {
+        string arg=argv[a]; bool more=a+1<argc;
+        if (arg=="--main"&&more) bins[0]=argv[++a];
+        else if (arg=="--dtap"&&more) bins[1]=argv[++a];
+        else if (arg=="--semantic"&&more) bins[2]=argv[++a];
+        else if (arg=="--min"&&more) minSize=parseSize(argv[++a]);
+        else if (arg=="--max"&&more) maxSize=parseSize(argv[++a]);
+        else if (arg=="--semantic-max"&&more) semMax=parseSize(argv[++a]);
+        else if (arg=="--baseline"&&more) baselinePath=argv[++a];
+        else if (arg=="--update-baseline") update=true;
+        else if (arg=="--max-slowdown"&&more) maxSlowdown=stod(argv[++a]);
+        else if (arg=="--max-rss-growth"&&more) maxRssGrowth=stod(argv[++a]);
+        else { cerr<<"Unknown option: "<<arg<<"\n"; return 1; }
+    }
+    for (auto& b: bins) if (b.find('/')==string::npos) b="./"+b;
+    // binaries run inside the work directory
+    char cwd[4096]; if(!getcwd(cwd,sizeof cwd)) return 1;
+    for (auto& b: bins) if (b[0]!='/') b=string(cwd)+"/"+b;
+
+    const string dir="scaling_work";
+    mkdir(dir.c_str(),0755);
+    auto baseline=loadBaseline(baselinePath);
+    ostringstream fresh; int failures=0;
+
+    cout<<left<<setw(10)<<"impl"<<setw(14)<<"bytes"<<setw(10)<<"MB/s"<<setw(12)<<"rss_kb"
+        <<setw(10)<<"values"<<"check\n";
+    for (uint64_t size=minSize; size<=maxSize; size*=16) {
+        string src=dir+"/program.txt";
+        if (!generate(src,size)) { cerr<<"Cannot write "<<src<<"\n"; return 1; }
+        unlink((dir+"/editor.txt").c_str()); unlink((dir+"/input.txt").c_str());
+        if (link(src.c_str(),(dir+"/editor.txt").c_str())!=0 || link(src.c_str(),(dir+"/input.txt").c_str())!=0) {
+            cerr<<"Cannot link inputs in "<<dir<<"\n"; return 1;
+        }
+        struct stat st{}; stat(src.c_str(),&st); uint64_t bytes=st.st_size;
+
+        RunResult res[3]; bool ran[3]={};
+        for (int k=0;k<3;++k) {
+            if (k==2 && size>semMax) continue;
+            res[k]=runOne(bins[k],dir,k==2); ran[k]=true;
+            double mbps=bytes/1048576.0/max(res[k].seconds,1e-9);
+            string check=res[k].ok? "ok":"FAILED(status "+to_string(res[k].status)+")";
+            if (!res[k].ok) ++failures;
+
+            string key=string(names[k])+"@"+to_string(bytes);
+            auto it=baseline.find(key);
+            if (res[k].ok && it!=baseline.end()) {
+                const Baseline& b=it->second;
+                if (b.outHash!=res[k].outHash || b.valueHash!=res[k].valueHash) { check="OUTPUT CHANGED"; ++failures; }
+                // runs shorter than minTimed are dominated by process start-up
+                else if (res[k].seconds>=minTimed && mbps < b.mbps*(1-maxSlowdown/100)) { check="SLOWER ("+to_string((int)(100-100*mbps/b.mbps))+"%)"; ++failures; }
+                else if (res[k].rssKb > b.rssKb*(1+maxRssGrowth/100) && res[k].rssKb-b.rssKb > 1024) { check="RSS GREW"; ++failures; }
+            }
+            fresh<<names[k]<<" "<<bytes<<" "<<mbps<<" "<<res[k].rssKb<<" "<<hex<<res[k].outHash<<" "<<res[k].valueHash<<dec<<"\n";
+            cout<<setw(10)<<names[k]<<setw(14)<<bytes<<setw(10)<<fixed<<setprecision(2)<<mbps
+                <<setw(12)<<res[k].rssKb<<setw(10)<<res[k].values<<check<<"\n";
+        }
+        // differential check on the common subset
+        for (int k=1;k<3;++k) if (ran[k] && res[k].ok && res[0].ok && res[k].valueHash!=res[0].valueHash) {
+            cout<<"  MISMATCH: "<<names[k]<<" disagrees with "<<names[0]<<" at "<<bytes<<" bytes\n";
+            ++failures;
+        }
+    }
+
+    if (update) { ofstream(baselinePath)<<fresh.str(); cout<<"Baseline written to "<<baselinePath<<"\n"; }
+    if (failures) { cout<<failures<<" check(s) failed\n"; return 2; }
+    return 0;
+}
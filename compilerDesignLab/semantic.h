@@ -0,0 +1,812 @@
+// semantic.h - lexer, parser, semantic analysis and annotated-AST output
+// for the integer/dekhao language. Used by semantic.cpp and compilerLib.
+#ifndef SEMANTIC_H
+#define SEMANTIC_H
+
+#include <bits/stdc++.h>
+
+namespace sema {
+using namespace std;
+
+// ===== Tokens =====
+enum class TokType {
+    KW_INTEGER, KW_DEKHAO, KW_TE, KW_BEGIN, KW_END,
+    IDENT, NUMBER,
+    PLUS, MINUS, STAR, SLASH,
+    LPAREN, RPAREN,
+    END
+};
+
+struct Token { TokType type; string lexeme; int line; };
+
+struct LexResult { vector<Token> tokens; vector<string> warnings; };
+
+class Lexer {
+public:
+    static LexResult lexLine(const string& s, int lineNo) {
+        size_t i = 0; LexResult R;
+        auto isIdStart = [](char c){ return isalpha((unsigned char)c) || c=='_'; };
+        auto isId = [](char c){ return isalnum((unsigned char)c) || c=='_'; };
+
+        while (i < s.size()) {
+            char c = s[i];
+            if (isspace((unsigned char)c)) { ++i; continue; }
+            if (isdigit((unsigned char)c)) {
+                size_t j=i; while (j<s.size() && isdigit((unsigned char)s[j])) ++j;
+                R.tokens.push_back({TokType::NUMBER, s.substr(i,j-i), lineNo}); i=j; continue;
+            }
+            if (isIdStart(c)) {
+                size_t j=i; while (j<s.size() && isId(s[j])) ++j;
+                word(R, s.substr(i,j-i), lineNo); i=j; continue;
+            }
+            symbol(R, c, lineNo);
+            ++i;
+        }
+        R.tokens.push_back({TokType::END,"",lineNo});
+        return R;
+    }
+
+    // Keyword or identifier; also used for pre-tokenized input (tokenStream.h)
+    static void word(LexResult& R, string w, int lineNo) {
+        auto push = [&](TokType t){ R.tokens.push_back({t,std::move(w),lineNo}); };
+        string lw=w; for (auto& ch:lw) ch=tolower(ch);
+        if (lw=="integer"||lw=="interger"){ if(lw=="interger") R.warnings.push_back("Line "+to_string(lineNo)+": 'interger' treated as 'integer'."); push(TokType::KW_INTEGER);}
+        else if (lw=="dekhao") push(TokType::KW_DEKHAO);
+        else if (lw=="te") push(TokType::KW_TE);
+        else if (lw=="begin") push(TokType::KW_BEGIN);
+        else if (lw=="end") push(TokType::KW_END);
+        else push(TokType::IDENT);
+    }
+
+    // Single-character operator, or a warning for anything else
+    static void symbol(LexResult& R, char c, int lineNo) {
+        auto push = [&](TokType t){ R.tokens.push_back({t,string(1,c),lineNo}); };
+        switch(c){
+            case '+': push(TokType::PLUS); break;
+            case '-': push(TokType::MINUS); break;
+            case '*': push(TokType::STAR); break;
+            case '/': push(TokType::SLASH); break;
+            case '(': push(TokType::LPAREN); break;
+            case ')': push(TokType::RPAREN); break;
+            default: R.warnings.push_back("Line "+to_string(lineNo)+": skipping unknown character '"+string(1,c)+"'."); break;
+        }
+    }
+};
+
+// ===== AST =====
+struct Node { virtual ~Node()=default; int line=0; };
+
+struct Expr : Node { int id=0; };  // id: index in ExprPool, stable key for hash-consing
+struct Stmt : Node {};
+
+struct Number : Expr { int value; explicit Number(int v){value=v;} };
+struct Ident  : Expr { string name; int sym=0; explicit Ident(string n){name=std::move(n);} };  // sym: ExprPool name id
+
+// Children are owned by ExprPool; with hash-consing on they may be shared.
+struct Binary : Expr {
+    string op; Expr *left, *right;
+    Binary(string o, Expr* l, Expr* r)
+        : op(std::move(o)), left(l), right(r) {}
+};
+
+struct Decl : Stmt {
+    string name; int value; int sym=0;
+    Decl(string n,int v){name=std::move(n); value=v;}
+};
+
+struct Print : Stmt {
+    Expr* expr; explicit Print(Expr* e):expr(e){}
+};
+
+// Block delimiters; statements between them form a nested scope.
+struct Begin : Stmt {};
+struct End   : Stmt {};
+
+// ===== Expression pool =====
+// Owns every expression node. With hashCons set, structurally identical
+// expressions are built once and shared, keyed by (kind, op/value, child ids),
+// so the program becomes a DAG and each unique subexpression is analyzed once.
+// A shared node keeps the line of its first occurrence.
+// Identifiers are also keyed by a binding epoch: it is 0 at top level and
+// changes on entering a block and on every declaration inside one, so two
+// uses share a node only if they must resolve to the same declaration.
+class ExprPool {
+public:
+    bool hashCons=false;
+    size_t requested=0, requestedBytes=0;   // what the expanded tree would hold
+
+    Expr* number(int v, int line){
+        return intern({'N',0,v,0}, sizeof(Number), [&]{ return make_unique<Number>(v); }, line);
+    }
+    Expr* ident(const string& n, int line){
+        int sym=nameId(n);
+        return intern({'I',0,sym,epochs.back()}, sizeof(Ident)+heap(n),
+                      [&]{ auto e=make_unique<Ident>(n); e->sym=sym; return e; }, line);
+    }
+
+    // dense id per distinct name; the semantic symbol table is indexed by it
+    int nameId(const string& n){ return names.emplace(n,(int)names.size()).first->second; }
+
+    void openScope(){ epochs.push_back(++lastEpoch); }
+    void closeScope(){ if (epochs.size()>1) epochs.pop_back(); }
+    void declared(){ if (epochs.size()>1) epochs.back()=++lastEpoch; }
+    Expr* binary(const string& op, Expr* l, Expr* r, int line){
+        return intern({'B',op[0],l->id,r->id}, sizeof(Binary), [&]{ return make_unique<Binary>(op,l,r); }, line);
+    }
+
+    size_t size() const { return nodes.size(); }
+    const Expr* at(size_t i) const { return nodes[i].get(); }
+    size_t bytes() const { return allocatedBytes; }
+    // Estimated heap use of the hash tables: one node per entry (value,
+    // next pointer, cached hash) plus the bucket array. The intern table
+    // exists only with hashCons; the name table is kept in both modes.
+    size_t tableBytes() const { return hashCons? mapBytes(table, sizeof(pair<const Key,Expr*>)) : 0; }
+    size_t nameBytes() const {
+        size_t n=mapBytes(names, sizeof(pair<const string,int>));
+        for (auto& kv: names) n+=heap(kv.first);
+        return n;
+    }
+
+private:
+    struct Key {
+        char kind, op; long long a, b;
+        bool operator==(const Key& o) const { return kind==o.kind&&op==o.op&&a==o.a&&b==o.b; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h=hash<long long>()(k.a)*1000003u ^ hash<long long>()(k.b);
+            return h*31u + (size_t)(unsigned char)k.kind*7u + (unsigned char)k.op;
+        }
+    };
+    vector<unique_ptr<Expr>> nodes;
+    unordered_map<Key, Expr*, KeyHash> table;
+    unordered_map<string,int> names;
+    vector<long long> epochs{0}; long long lastEpoch=0;
+    size_t allocatedBytes=0;
+
+    static size_t heap(const string& s){ return s.capacity()>15 ? s.capacity()+1 : 0; }
+    template<class M> static size_t mapBytes(const M& m, size_t value){
+        return m.size()*(value+2*sizeof(void*)) + m.bucket_count()*sizeof(void*);
+    }
+
+    template<class Make>
+    Expr* intern(const Key& k, size_t sz, Make make, int line){
+        ++requested; requestedBytes+=sz;
+        if (hashCons) { auto it=table.find(k); if (it!=table.end()) return it->second; }
+        auto e=make(); e->id=(int)nodes.size(); e->line=line; allocatedBytes+=sz;
+        Expr* raw=e.get(); nodes.push_back(std::move(e));
+        if (hashCons) table.emplace(k,raw);
+        return raw;
+    }
+};
+
+// ===== Parser =====
+class Parser {
+public:
+    Parser(const vector<Token>& t, ExprPool& p) : toks(t), pool(p) {}
+    unique_ptr<Stmt> parseStatement(string& err) {
+        if (match(TokType::KW_INTEGER)) return parseDecl(err);
+        if (match(TokType::KW_DEKHAO))  return parsePrint(err);
+        if (match(TokType::KW_BEGIN))   { pool.openScope();  return parseBlockMark<Begin>(err); }
+        if (match(TokType::KW_END))     { pool.closeScope(); return parseBlockMark<End>(err); }
+        err = here()+"Expected 'integer', 'dekhao', 'begin' or 'end'."; return nullptr;
+    }
+    bool atEnd() const { return peek().type==TokType::END; }
+private:
+    const vector<Token>& toks; ExprPool& pool; size_t i=0;
+    const Token& peek(size_t k=0) const { return toks[min(i+k, toks.size()-1)]; }
+    bool check(TokType t,size_t k=0) const { return peek(k).type==t; }
+    const Token& advance(){ if(!atEnd()) ++i; return toks[i-1]; }
+    bool match(TokType t){ if(check(t)){ advance(); return true; } return false; }
+    string here() const { return "Line "+to_string(peek().line)+": "; }
+
+    unique_ptr<Stmt> parseDecl(string& err){
+        if(!check(TokType::IDENT)){ err=here()+"Expected identifier after 'integer'."; return nullptr; }
+        auto idTok=advance(); string name=idTok.lexeme;
+        if(!match(TokType::KW_TE)){ err=here()+"Expected 'te' after identifier."; return nullptr; }
+        if(!check(TokType::NUMBER)){ err=here()+"Expected integer literal after 'te'."; return nullptr; }
+        int val=stoi(advance().lexeme);
+        auto d=make_unique<Decl>(name,val); d->line=idTok.line; d->sym=pool.nameId(name);
+        if(!atEnd()){ err=here()+"Unexpected tokens after declaration."; return nullptr; }
+        pool.declared();
+        return d;
+    }
+    template<class Mark> unique_ptr<Stmt> parseBlockMark(string& err){
+        int ln=toks[i-1].line;
+        if(!atEnd()){ err=here()+"Unexpected tokens after '"+toks[i-1].lexeme+"'."; return nullptr; }
+        auto m=make_unique<Mark>(); m->line=ln; return m;
+    }
+    unique_ptr<Stmt> parsePrint(string& err){
+        int ln=peek().line;
+        if(!match(TokType::LPAREN)){ err=here()+"Expected '(' after 'dekhao'."; return nullptr; }
+        auto e=parseExpr(err); if(!e) return nullptr;
+        if(!match(TokType::RPAREN)){ err=here()+"Expected ')' after expression."; return nullptr; }
+        if(!atEnd()){ err=here()+"Unexpected tokens after print statement."; return nullptr; }
+        auto p=make_unique<Print>(e); p->line=ln; return p;
+    }
+
+    // Operator-precedence parse with explicit operand/operator stacks ('('
+    // stays on the operator stack as a marker), so neither nesting depth nor
+    // expression length uses native stack. The stacks are reused by every
+    // parse on the thread. Nodes are built in the same (post)order as
+    // recursive descent over expr/term/factor, so pool ids, shared nodes and
+    // the first syntax error are unchanged.
+    Expr* parseExpr(string& err){
+        static thread_local vector<Expr*> vals;
+        static thread_local vector<char> ops;
+        vals.clear(); ops.clear();
+        auto prec=[](char op){ return op=='*'||op=='/'? 2 : op=='('? 0 : 1; };
+        auto reduce=[&]{
+            Expr* r=vals.back(); vals.pop_back();
+            vals.back()=pool.binary(string(1,ops.back()),vals.back(),r,peek().line); ops.pop_back();
+        };
+        while(true){
+            while(match(TokType::LPAREN)) ops.push_back('(');
+            if(check(TokType::IDENT)){ auto& t=advance(); vals.push_back(pool.ident(t.lexeme,t.line)); }
+            else if(check(TokType::NUMBER)){ auto& t=advance(); vals.push_back(pool.number(stoi(t.lexeme),t.line)); }
+            else { err=here()+"Expected identifier, number, or '('."; return nullptr; }
+            // after an operand: operator, ')' or end of expression
+            while(true){
+                TokType t=peek().type;
+                if(t==TokType::PLUS||t==TokType::MINUS||t==TokType::STAR||t==TokType::SLASH){
+                    char op=peek().lexeme[0];
+                    while(!ops.empty() && prec(ops.back())>=prec(op)) reduce();
+                    ops.push_back(op); advance(); break;
+                }
+                while(!ops.empty() && ops.back()!='(') reduce();
+                if(ops.empty()) return vals.back();
+                if(!match(TokType::RPAREN)){ err=here()+"Expected ')'."; return nullptr; }
+                ops.pop_back();
+            }
+        }
+    }
+};
+
+// ===== Semantic annotations =====
+enum class Type { Int, Unknown };
+
+struct Annotation {
+    Type type = Type::Unknown;
+    bool isConst = false;
+    long long constVal = 0;
+    const Decl* resolvedDecl = nullptr; // for identifiers
+};
+
+// ===== Scoped symbol table =====
+// Names are dense ids (ExprPool::nameId), so a lookup is one array index:
+// top[sym] is the innermost live binding. Bindings live on one stack and
+// remember the binding they shadow; closing a scope pops its own entries and
+// restores top[], so the cost is O(1) per declaration whatever the nesting
+// depth, and a closed scope leaves nothing behind.
+class ScopedSymbols {
+public:
+    void open(){ marks.push_back(bindings.size()); }
+    bool close(){
+        if (marks.empty()) return false;
+        size_t m=marks.back(); marks.pop_back();
+        while (bindings.size()>m) { auto& b=bindings.back(); top[b.sym]=b.shadowed; bindings.pop_back(); }
+        return true;
+    }
+    // Binds d in the innermost scope. Returns the declaration it clashes
+    // with in that same scope (d is then not bound), otherwise nullptr.
+    const Decl* declare(const Decl* d){
+        if ((size_t)d->sym>=top.size()) top.resize(d->sym+1,-1);
+        int cur=top[d->sym];
+        if (cur>=0 && (size_t)cur>=(marks.empty()? 0 : marks.back())) return bindings[cur].decl;
+        bindings.push_back({d->sym,cur,d}); top[d->sym]=(int)bindings.size()-1;
+        return nullptr;
+    }
+    const Decl* lookup(int sym) const {
+        return (size_t)sym<top.size() && top[sym]>=0 ? bindings[top[sym]].decl : nullptr;
+    }
+    size_t depth() const { return marks.size(); }
+private:
+    struct Binding { int sym; int shadowed; const Decl* decl; };
+    vector<int> top;
+    vector<Binding> bindings;
+    vector<size_t> marks;
+};
+
+struct Semantic {
+    unordered_map<const Node*, Annotation> ann;
+    ScopedSymbols sym;  // top-level scope plus one per open begin/end block
+    vector<string> errors;
+    vector<string> notes;
+
+    // Top-level declarations are visible to every statement, as before blocks
+    // existed; a declaration inside a block is visible from its line to the
+    // block's 'end' and shadows outer ones.
+    void analyze(vector<unique_ptr<Stmt>>& prog) {
+        // 1) collect top-level decls
+        size_t depth=0;
+        for (auto& s: prog) {
+            if (dynamic_cast<Begin*>(s.get())) ++depth;
+            else if (dynamic_cast<End*>(s.get())) { if (depth) --depth; }
+            else if (auto d = dynamic_cast<Decl*>(s.get())) {
+                if (!depth) declare(d);
+            }
+        }
+
+        // 2) analyze statements in order, opening and closing block scopes
+        vector<const Stmt*> open;  // begins not yet closed, outermost first
+        for (auto& s: prog) {
+            if (dynamic_cast<Begin*>(s.get())) { sym.open(); open.push_back(s.get()); }
+            else if (dynamic_cast<End*>(s.get())) {
+                if (!sym.close()) errors.push_back(loc(s.get())+"'end' without matching 'begin'.");
+                else open.pop_back();
+            }
+            else if (auto d = dynamic_cast<Decl*>(s.get())) {
+                if (sym.depth()) declare(d);
+            }
+            else if (auto p = dynamic_cast<Print*>(s.get())) {
+                analyzeExpr(p->expr, p->line);
+                // print node annotation: type must be Int
+                Annotation A; A.type = get(p->expr).type;
+                A.isConst = get(p->expr).isConst;
+                if (A.isConst) A.constVal = get(p->expr).constVal;
+                ann[p]=A;
+            }
+        }
+        for (auto b: open) errors.push_back(loc(b)+"'begin' without matching 'end'.");
+    }
+
+    void declare(const Decl* d){
+        if (sym.declare(d)) errors.push_back(loc(d)+"Redeclaration of '"+d->name+"'.");
+        Annotation A; A.type=Type::Int; A.isConst=true; A.constVal=d->value;
+        ann[d]=A;
+    }
+
+    // Post-order walk on an explicit stack: a flat million-term sum is a
+    // million-deep tree. Children are annotated left before right, as the
+    // errors are reported in that order. line is the use site: with
+    // hash-consing a subexpression met again is not re-analyzed, but the
+    // errors below it are reported again there, as in the expanded tree.
+    void analyzeExpr(Expr* root, int line){
+        vector<pair<Expr*,bool>> stack{{root,false}};   // second: children done
+        while (!stack.empty()) {
+            auto [e,ready]=stack.back(); stack.pop_back();
+            if (!ready && ann.count(e)) { replayErrors(e,line); continue; }  // shared (hash-consed) node
+            auto b = dynamic_cast<Binary*>(e);
+            if (b && !ready) { stack.push_back({e,true}); stack.push_back({b->right,false}); stack.push_back({b->left,false}); continue; }
+            string msg;
+            ann[e]=annotate(e,msg);
+            size_t n=0;
+            if (!msg.empty()) { errors.push_back(at(line)+msg); exprError[e]=std::move(msg); n=1; }
+            if (b) n+=errorsIn(b->left)+errorsIn(b->right);
+            if (n) errorsBelow[e]=n;
+        }
+    }
+
+    // Errors of the expanded subtree of an annotated node, in post-order
+    void replayErrors(const Expr* root, int line){
+        if (!errorsIn(root)) return;
+        vector<pair<const Expr*,bool>> stack{{root,false}};
+        while (!stack.empty()) {
+            auto [e,ready]=stack.back(); stack.pop_back();
+            auto b = dynamic_cast<const Binary*>(e);
+            if (b && !ready) {
+                stack.push_back({e,true});
+                if (errorsIn(b->right)) stack.push_back({b->right,false});
+                if (errorsIn(b->left)) stack.push_back({b->left,false});
+                continue;
+            }
+            auto it=exprError.find(e); if (it!=exprError.end()) errors.push_back(at(line)+it->second);
+        }
+    }
+    size_t errorsIn(const Expr* e) const { auto it=errorsBelow.find(e); return it==errorsBelow.end()? 0 : it->second; }
+
+    // annotation of one node whose children are already annotated; its own
+    // error, if any, goes to msg (without location)
+    Annotation annotate(const Expr* e, string& msg){
+        Annotation A;
+        if (auto n = dynamic_cast<const Number*>(e)) {
+            A.type=Type::Int; A.isConst=true; A.constVal=n->value; return A;
+        }
+        if (auto id = dynamic_cast<const Ident*>(e)) {
+            const Decl* d = sym.lookup(id->sym);
+            if (!d) {
+                msg="Use of undeclared identifier '"+id->name+"'.";
+                A.type=Type::Unknown;
+            } else {
+                A.type=Type::Int; A.isConst=true; A.constVal=d->value; A.resolvedDecl=d;
+            }
+            return A;
+        }
+        if (auto b = dynamic_cast<const Binary*>(e)) {
+            const Annotation &L=get(b->left), &R=get(b->right);
+            if (L.type==Type::Int && R.type==Type::Int) {
+                A.type = Type::Int;
+                // constant fold if both const
+                if (L.isConst && R.isConst) {
+                    A.isConst = true;
+                    if (b->op=="+") A.constVal = L.constVal + R.constVal;
+                    else if (b->op=="-") A.constVal = L.constVal - R.constVal;
+                    else if (b->op=="*") A.constVal = L.constVal * R.constVal;
+                    else if (b->op=="/") {
+                        if (R.constVal==0) {
+                            msg="Division by zero in constant expression.";
+                            A.isConst=false;
+                        } else A.constVal = L.constVal / R.constVal;
+                    }
+                }
+            } else {
+                A.type = Type::Unknown;
+                msg="Type error: operands must be integers.";
+            }
+            return A;
+        }
+        // fallback
+        return A;
+    }
+
+    const Annotation& get(const Node* n) const {
+        static Annotation empty;
+        auto it=ann.find(n); return it==ann.end()?empty:it->second;
+    }
+
+    static string tstr(Type t){ return t==Type::Int? "int" : "unknown"; }
+
+    static string loc(const Node* n){ return at(n? n->line:0); }
+    static string at(int ln){ if(!ln) return ""; return "Line "+to_string(ln)+": "; }
+
+private:
+    unordered_map<const Expr*, string> exprError;    // a node's own error, without location
+    unordered_map<const Expr*, size_t> errorsBelow;  // errors in its expanded subtree (own included), if any
+};
+
+// ===== Pretty printers =====
+// dag=false prints every occurrence (expanded tree). dag=true tags nodes with
+// their pool id and prints a shared subexpression only the first time.
+struct ASTPrinter {
+    bool dag=false;
+    unordered_set<const Expr*> seen;
+
+    void print(const vector<unique_ptr<Stmt>>& program, const Semantic& S) {
+        cout << "=== Annotated Semantic " << (dag? "DAG":"Tree") << " ===\n";
+        // statements inside begin/end are indented one step per level
+        int i=1, depth=0; for (auto& s: program) {
+            if (dynamic_cast<const End*>(s.get()) && depth) --depth;
+            string pad(2*depth,' ');
+            cout << pad << "Stmt " << i++ << ":\n";
+            printStmt(*s, S, 2+2*depth);
+            if (dynamic_cast<const Begin*>(s.get())) ++depth;
+        }
+    }
+    void printStmt(const Stmt& s, const Semantic& S, int indent){
+        string pad(indent,' ');
+        if (auto d = dynamic_cast<const Decl*>(&s)) {
+            auto A=S.get(&s);
+            cout << pad << "Decl(integer)  :: type=" << Semantic::tstr(A.type)
+                 << ", const=" << (A.isConst? "true ("+to_string(A.constVal)+")":"false") << "\n";
+            cout << pad << "  name: " << d->name << "\n";
+            cout << pad << "  value: " << d->value << "\n";
+        } else if (auto p = dynamic_cast<const Print*>(&s)) {
+            auto A=S.get(&s);
+            cout << pad << "Print(dekhao)  :: expr.type=" << Semantic::tstr(A.type);
+            if (A.isConst) cout << ", expr.const=" << A.constVal;
+            cout << "\n";
+            cout << pad << "  expr:\n";
+            printExpr(*p->expr, S, indent+4);
+        } else if (dynamic_cast<const Begin*>(&s)) {
+            cout << pad << "Begin(block)\n";
+        } else if (dynamic_cast<const End*>(&s)) {
+            cout << pad << "End(block)\n";
+        }
+    }
+    // Explicit stack, as one dekhao line can nest arbitrarily deep. Each
+    // entry carries the "left:"/"right:" label its parent prints before it,
+    // and right is pushed before left, so the output is the same pre-order
+    // walk as a recursive printer.
+    void printExpr(const Expr& root, const Semantic& S, int indent){
+        struct Item { const Expr* e; int indent; const char* label; };
+        vector<Item> stack{{&root,indent,nullptr}};
+        while (!stack.empty()) {
+            Item it=stack.back(); stack.pop_back();
+            const Expr& e=*it.e;
+            string pad(it.indent,' '), head=pad;
+            if (it.label) cout << string(it.indent-2,' ') << it.label << ":\n";
+            if (dag) {
+                if (!seen.insert(&e).second) { cout << pad << "#" << e.id << " (shared)\n"; continue; }
+                head += "#"+to_string(e.id)+" ";
+            }
+            auto A=S.get(&e);
+            if (auto n = dynamic_cast<const Number*>(&e)) {
+                cout << head << "Number(" << n->value << ")  :: type=" << Semantic::tstr(A.type)
+                     << ", const=" << (A.isConst? "true ("+to_string(A.constVal)+")":"false") << "\n";
+            } else if (auto id = dynamic_cast<const Ident*>(&e)) {
+                cout << head << "Ident(" << id->name << ")  :: type=" << Semantic::tstr(A.type);
+                if (A.resolvedDecl) cout << ", binds→" << A.resolvedDecl->name;
+                if (A.isConst) cout << ", const=" << A.constVal;
+                cout << "\n";
+            } else if (auto b = dynamic_cast<const Binary*>(&e)) {
+                cout << head << "BinaryOp(" << b->op << ")  :: type=" << Semantic::tstr(A.type);
+                if (A.isConst) cout << ", const=" << A.constVal;
+                cout << "\n";
+                stack.push_back({b->right, it.indent+4, "right"});
+                stack.push_back({b->left,  it.indent+4, "left"});
+            } else {
+                cout << head << "<expr?> :: type=" << Semantic::tstr(A.type) << "\n";
+            }
+        }
+    }
+};
+
+// ===== Buffered writer =====
+// Big user-space buffer over FILE*; integers are formatted in place (to_chars),
+// so writing a label never builds a temporary string.
+class OutBuf {
+public:
+    explicit OutBuf(const string& path, size_t cap=1<<20)
+        : f(fopen(path.c_str(),"wb")), buf(cap) {}
+    ~OutBuf(){ flush(); if(f) fclose(f); }
+    bool ok() const { return f!=nullptr; }
+
+    OutBuf& operator<<(string_view s){ write(s.data(), s.size()); return *this; }
+    OutBuf& operator<<(char c){ if(len==buf.size()) flush(); buf[len++]=c; return *this; }
+    OutBuf& operator<<(long long v){
+        if(buf.size()-len<24) flush();
+        len=to_chars(buf.data()+len, buf.data()+buf.size(), v).ptr-buf.data(); return *this;
+    }
+    OutBuf& operator<<(int v){ return *this<<(long long)v; }
+
+    void write(const void* p, size_t n){
+        if(n>buf.size()-len){ flush(); if(n>buf.size()){ if(f) fwrite(p,1,n,f); return; } }
+        memcpy(buf.data()+len,p,n); len+=n;
+    }
+    void flush(){ if(f&&len) fwrite(buf.data(),1,len,f); len=0; }
+
+private:
+    FILE* f; vector<char> buf; size_t len=0;
+};
+
+// ===== DOT with annotations =====
+// Streams straight into OutBuf. Labels are fixed templates plus identifiers,
+// operators and numbers, none of which can contain '"', so nothing is escaped.
+// In dag mode each expression node is emitted once and every use gets an edge to it.
+// maxDepth / maxNodes (-1 = unlimited) collapse the rest of a subtree into
+// one "..." node that reports how many expression nodes it hides; once
+// maxNodes is reached the remaining statements are collapsed the same way.
+struct DOT {
+    OutBuf out; int nextId=0;
+    bool dag=false;
+    int maxDepth=-1;
+    long long maxNodes=-1;
+    unordered_map<const Expr*, int> emitted;
+    unordered_map<const Expr*, long long> sizes;
+
+    DOT(const string& path, bool asDag):out(path),dag(asDag){ out<<"digraph AnnotatedAST {\n  node [shape=box];\n"; }
+    ~DOT(){ out<<"}\n"; }
+
+    int open(){ int id=nextId++; out<<"  n"<<id<<" [label=\""; return id; }
+    void close(){ out<<"\"];\n"; }
+    int node(string_view label){ int id=open(); out<<label; close(); return id; }
+    void edge(int a,int b,string_view el=""){ out<<"  n"<<a<<" -> n"<<b; if(!el.empty()) out<<" [label=\""<<el<<"\"]"; out<<";\n"; }
+    void edge(int a,int b,string_view el,int idx){ out<<"  n"<<a<<" -> n"<<b<<" [label=\""<<el<<idx<<"\"];\n"; }
+
+    void type(Type t){ out<<(t==Type::Int? "int":"unknown"); }
+    bool spent() const { return maxNodes>=0 && nextId>=maxNodes; }
+
+    // Program root and one subtree per statement. Once maxNodes is spent the
+    // remaining statements become a single "..." node, so the budget bounds
+    // the whole graph.
+    void emitProgram(const vector<unique_ptr<Stmt>>& program, const Semantic& S){
+        int root=node("Program");
+        for (size_t k=0; k<program.size(); ++k) {
+            if (spent()) {
+                int r=open(); out<<"...\\n"<<(long long)(program.size()-k)<<" statements"; close();
+                edge(root,r,"stmt",(int)k+1); return;
+            }
+            int r=emitStmt(*program[k],S);
+            edge(root,r,"stmt",(int)k+1);
+        }
+    }
+
+    int emitStmt(const Stmt& s, const Semantic& S){
+        if (auto d=dynamic_cast<const Decl*>(&s)){
+            auto& A=S.get(&s);
+            int r=open(); out<<"Decl\\n(integer)\\n:type="; type(A.type); out<<"\\nconst=";
+            if (A.isConst) out<<"true("<<A.constVal<<')'; else out<<"false";
+            close();
+            int n1=open(); out<<"name="<<d->name; close();
+            int n2=open(); out<<"value="<<d->value; close();
+            edge(r,n1); edge(r,n2); return r;
+        } else if (auto p=dynamic_cast<const Print*>(&s)){
+            auto& A=S.get(&s);
+            int r=open(); out<<"Print\\n(dekhao)\\nexpr.type="; type(A.type);
+            if (A.isConst) out<<"\\nexpr.const="<<A.constVal;
+            close();
+            int e=emitExpr(*p->expr,S,1); edge(r,e,"expr"); return r;
+        } else if (dynamic_cast<const Begin*>(&s)) {
+            return node("Begin\\n(block)");
+        } else if (dynamic_cast<const End*>(&s)) {
+            return node("End\\n(block)");
+        }
+        return node("<stmt?>");
+    }
+
+    // Binary nodes whose children are still being emitted. Explicit stack,
+    // as one dekhao line can nest arbitrarily deep; left is finished before
+    // right is started, so ids and edges come out in recursive order.
+    struct Pending { const Binary* b; int depth, r, L=-1, next=0; };
+    vector<Pending> pending;
+
+    int emitExpr(const Expr& root, const Semantic& S, int depth){
+        int res=enterExpr(root,S,depth);
+        while (!pending.empty()) {
+            Pending& p=pending.back();
+            if (p.next==1 && res>=0) p.L=res;
+            if (p.next<2) {
+                const Expr& child=p.next? *p.b->right : *p.b->left;
+                int d=p.depth+1; ++p.next;
+                res=enterExpr(child,S,d);   // may push, p is not used after this
+                continue;
+            }
+            edge(p.r,p.L,"left"); edge(p.r,res,"right");
+            res=p.r; pending.pop_back();
+        }
+        return res;
+    }
+
+    // Id of e's node, or -1 if e is a Binary now waiting on pending.
+    int enterExpr(const Expr& e, const Semantic& S, int depth){
+        if ((maxDepth>=0 && depth>maxDepth) || spent()) {
+            int r=open(); out<<"...\\n"<<treeSize(e)<<" nodes"; close(); return r;
+        }
+        if (dag) {
+            auto it=emitted.find(&e); if (it!=emitted.end()) return it->second;
+        }
+        return emitExprNode(e,S,depth);
+    }
+
+    int emitExprNode(const Expr& e, const Semantic& S, int depth){
+        auto& A=S.get(&e); int r;
+        if (auto n=dynamic_cast<const Number*>(&e)) {
+            r=open(); out<<"Number\\n"<<n->value<<"\\n:type="; type(A.type); out<<"\\nconst=";
+            if (A.isConst) out<<"true("<<A.constVal<<')'; else out<<"false";
+            close();
+        } else if (auto id=dynamic_cast<const Ident*>(&e)) {
+            r=open(); out<<"Ident\\n"<<id->name<<"\\n:type="; type(A.type);
+            if (A.resolvedDecl) out<<"\\nbinds→"<<A.resolvedDecl->name;
+            if (A.isConst) out<<"\\nconst="<<A.constVal;
+            close();
+        } else if (auto b=dynamic_cast<const Binary*>(&e)) {
+            r=open(); out<<"BinaryOp\\n"<<b->op<<"\\n:type="; type(A.type);
+            if (A.isConst) out<<"\\nconst="<<A.constVal;
+            close();
+            // an expression is never its own descendant, so recording it
+            // before its children are emitted is safe
+            if (dag) emitted[&e]=r;
+            pending.push_back({b,depth,r});
+            return -1;
+        } else {
+            r=node("<expr?>");
+        }
+        if (dag) emitted[&e]=r;
+        return r;
+    }
+
+    // expanded node count of a subtree (memoized, so shared DAG nodes are
+    // cheap; explicit stack, as a collapsed subtree can be arbitrarily deep)
+    long long treeSize(const Expr& root){
+        vector<const Expr*> stack{&root};
+        while (!stack.empty()) {
+            const Expr* e=stack.back();
+            if (sizes.count(e)) { stack.pop_back(); continue; }
+            auto b=dynamic_cast<const Binary*>(e);
+            if (!b) { sizes[e]=1; stack.pop_back(); continue; }
+            auto l=sizes.find(b->left), r=sizes.find(b->right);
+            if (l!=sizes.end() && r!=sizes.end()) { sizes[e]=1+l->second+r->second; stack.pop_back(); continue; }
+            if (r==sizes.end()) stack.push_back(b->right);
+            if (l==sizes.end()) stack.push_back(b->left);
+        }
+        return sizes[&root];
+    }
+};
+
+// ===== Binary export =====
+// annotated_ast.bin, host byte order, fixed-size records so it can be mmap'ed:
+//   header : "AAST" | u32 version | u32 exprCount | u32 stmtCount | u64 stringBytes
+//   records: exprCount expression records (index = pool id, children first),
+//            then stmtCount statement records
+//   strings: NUL-terminated names, referenced by byte offset
+// Record fields by kind:
+//   Number  a=value
+//   Ident   a=name offset   b=index of bound Decl record or -1
+//   Binary  a=left index    b=right index   op='+','-','*','/'
+//   Decl    a=name offset   b=value
+//   Print   a=expr index
+//   Begin / End  (block delimiters, version 2+)
+struct AstRecord {
+    uint8_t kind, op, type, flags;   // flags: 1=isConst
+    int32_t line;
+    int32_t a, b;
+    int64_t constVal;
+};
+static_assert(sizeof(AstRecord)==24, "AstRecord layout");
+
+struct AstHeader {
+    char magic[4]; uint32_t version, exprCount, stmtCount; uint64_t stringBytes;
+};
+static_assert(sizeof(AstHeader)==24, "AstHeader layout");
+
+enum AstKind : uint8_t { AK_NUMBER, AK_IDENT, AK_BINARY, AK_DECL, AK_PRINT, AK_BEGIN, AK_END };
+
+inline bool exportBinary(const string& path, const vector<unique_ptr<Stmt>>& program,
+                         const ExprPool& pool, const Semantic& S){
+    OutBuf out(path); if (!out.ok()) return false;
+    const uint32_t nExpr=(uint32_t)pool.size(), nStmt=(uint32_t)program.size();
+
+    string strings; unordered_map<string,int32_t> offs;
+    auto str=[&](const string& s){
+        auto it=offs.find(s); if (it!=offs.end()) return it->second;
+        int32_t o=(int32_t)strings.size(); strings.append(s); strings.push_back('\0');
+        offs.emplace(s,o); return o;
+    };
+    unordered_map<const Decl*, int32_t> declIdx;
+    for (uint32_t i=0;i<nStmt;++i)
+        if (auto d=dynamic_cast<const Decl*>(program[i].get())) declIdx[d]=(int32_t)(nExpr+i);
+    auto rec=[&](const Node* n, uint8_t kind){
+        auto& A=S.get(n); AstRecord r{};
+        r.kind=kind; r.type=(uint8_t)A.type; r.flags=A.isConst; r.line=n->line; r.constVal=A.constVal;
+        return r;
+    };
+
+    vector<AstRecord> recs; recs.reserve(nExpr+nStmt);
+    for (uint32_t i=0;i<nExpr;++i) {
+        const Expr* e=pool.at(i); AstRecord r{};
+        if (auto n=dynamic_cast<const Number*>(e)) { r=rec(e,AK_NUMBER); r.a=n->value; }
+        else if (auto id=dynamic_cast<const Ident*>(e)) {
+            r=rec(e,AK_IDENT); r.a=str(id->name);
+            auto rd=S.get(e).resolvedDecl; r.b=rd? declIdx[rd] : -1;
+        } else if (auto b=dynamic_cast<const Binary*>(e)) {
+            r=rec(e,AK_BINARY); r.op=(uint8_t)b->op[0]; r.a=b->left->id; r.b=b->right->id;
+        }
+        recs.push_back(r);
+    }
+    for (auto& s: program) {
+        AstRecord r{};
+        if (auto d=dynamic_cast<const Decl*>(s.get())) { r=rec(d,AK_DECL); r.a=str(d->name); r.b=d->value; }
+        else if (auto p=dynamic_cast<const Print*>(s.get())) { r=rec(p,AK_PRINT); r.a=p->expr->id; }
+        else if (dynamic_cast<const Begin*>(s.get())) r=rec(s.get(),AK_BEGIN);
+        else if (dynamic_cast<const End*>(s.get())) r=rec(s.get(),AK_END);
+        recs.push_back(r);
+    }
+
+    AstHeader h{{'A','A','S','T'}, 2, nExpr, nStmt, strings.size()};
+    out.write(&h,sizeof h);
+    out.write(recs.data(), recs.size()*sizeof(AstRecord));
+    out.write(strings.data(), strings.size());
+    return true;
+}
+
+inline string trim(const string& s){
+    auto l=s.find_first_not_of(" \t\r\n"), r=s.find_last_not_of(" \t\r\n");
+    if (l==string::npos) return "";
+    return s.substr(l,r-l+1);
+}
+
+// ===== Front end driver =====
+// Parse one lexed (non-empty) source line and append the statement to
+// program. onToken sees every token except END. Returns false with err set
+// on a syntax error. parseLine() lexes a trimmed line first.
+inline bool parseTokens(const LexResult& L, ExprPool& pool,
+                        vector<unique_ptr<Stmt>>& program, vector<string>& warnings, string& err,
+                        const function<void(const Token&)>& onToken = nullptr){
+    warnings.insert(warnings.end(), L.warnings.begin(), L.warnings.end());
+    if (onToken) for (auto &tk : L.tokens) if (tk.type!=TokType::END) onToken(tk);
+    Parser P(L.tokens, pool);
+    auto stmt = P.parseStatement(err);
+    if (!stmt) return false;
+    program.push_back(std::move(stmt));
+    return true;
+}
+
+inline bool parseLine(const string& text, int lineNo, ExprPool& pool,
+                      vector<unique_ptr<Stmt>>& program, vector<string>& warnings, string& err,
+                      const function<void(const Token&)>& onToken = nullptr){
+    return parseTokens(Lexer::lexLine(text, lineNo), pool, program, warnings, err, onToken);
+}
+
+} // namespace sema
+
+#endif
@@ -0,0 +1,156 @@
+// tokenStream.h - compact binary token file ("TOKS") written by
+// tokenizetion.cpp and read in place (mmap) by the other front ends, so a
+// source is tokenized once per pipeline run.
+//
+// Layout (host byte order):
+//   Header
+//   Record     records[tokenCount]      in source order
+//   uint64_t   lineStarts[lineCount+1]  index of the first record of each line
+//   char       strings[stringBytes]     NUL-terminated lexemes, deduplicated
+//
+// Lexical rules (the same as semantic.cpp's Lexer, plus string literals):
+// a run of digits is a NUMBER, [A-Za-z_][A-Za-z0-9_]* is a WORD (keywords
+// are left to the reader), '"' up to the next '"' on the line (or its end)
+// is a STRING with its quotes, whitespace separates, any other byte is a
+// one-char SYMBOL. Version 1 files have no STRING records.
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace toks {
+
+enum Kind : uint8_t { WORD, NUMBER, SYMBOL, STRING };
+
+struct Header {
+    char magic[4];             // "TOKS"
+    uint32_t version;          // 1 or 2 (2 adds STRING)
+    uint64_t tokenCount, lineCount, stringBytes, sourceBytes;
+};
+static_assert(sizeof(Header)==40, "toks::Header layout");
+
+struct Record {
+    uint8_t kind, pad[3];
+    uint32_t line;             // 1-based source line
+    uint64_t offset;           // byte offset in the source
+    uint32_t length;           // bytes in the source
+    uint32_t str;              // lexeme offset in the string table
+};
+static_assert(sizeof(Record)==24, "toks::Record layout");
+
+const uint32_t VERSION = 2;
+
+// Streams records to disk; line starts and strings are appended by finish().
+class Writer {
+public:
+    bool open(const std::string& path){
+        f=fopen(path.c_str(),"wb"); if(!f) return false;
+        setvbuf(f,nullptr,_IOFBF,1<<20);
+        Header h{}; return fwrite(&h,sizeof h,1,f)==1;   // placeholder, rewritten by finish()
+    }
+    void beginLine(){ lineStarts.push_back(count); }
+    void add(Kind k, uint32_t line, uint64_t offset, const char* text, uint32_t len){
+        Record r{}; r.kind=k; r.line=line; r.offset=offset; r.length=len; r.str=intern(text,len);
+        if (fwrite(&r,sizeof r,1,f)!=1) failed=true;
+        ++count;
+    }
+    bool finish(uint64_t sourceBytes){
+        Header h{{'T','O','K','S'},VERSION,count,lineStarts.size(),strings.size(),sourceBytes};
+        lineStarts.push_back(count);
+        fwrite(lineStarts.data(),sizeof(uint64_t),lineStarts.size(),f);
+        fwrite(strings.data(),1,strings.size(),f);
+        bool ok=!failed && !ferror(f) && fseek(f,0,SEEK_SET)==0 && fwrite(&h,sizeof h,1,f)==1;
+        return fclose(f)==0 && ok;
+    }
+private:
+    FILE* f=nullptr; uint64_t count=0; bool failed=false;
+    std::vector<uint64_t> lineStarts;
+    std::string strings;
+    std::unordered_map<std::string,uint32_t> offs;
+
+    uint32_t intern(const char* p, uint32_t n){
+        auto it=offs.emplace(std::string(p,n),(uint32_t)strings.size());
+        if (it.second) { strings.append(p,n); strings.push_back('\0'); }
+        return it.first->second;
+    }
+};
+
+// Tokenizes one line by the rules above and hands each token to the writer.
+inline void scanLine(Writer& w, const std::string& s, uint32_t line, uint64_t base){
+    w.beginLine();
+    size_t i=0;
+    while (i<s.size()) {
+        unsigned char c=s[i]; size_t j=i+1;
+        if (isspace(c)) { ++i; continue; }
+        Kind k=SYMBOL;
+        if (isdigit(c)) { k=NUMBER; while (j<s.size() && isdigit((unsigned char)s[j])) ++j; }
+        else if (c=='"') { k=STRING; while (j<s.size() && s[j]!='"') ++j; if (j<s.size()) ++j; }
+        else if (isalpha(c) || c=='_') { k=WORD; while (j<s.size() && (isalnum((unsigned char)s[j]) || s[j]=='_')) ++j; }
+        w.add(k,line,base+i,s.data()+i,(uint32_t)(j-i));
+        i=j;
+    }
+}
+
+// Maps a token file read-only and exposes it without copying.
+class Reader {
+public:
+    ~Reader(){ if (base) munmap(base,size); }
+    bool open(const std::string& path, std::string& err){
+        int fd=::open(path.c_str(),O_RDONLY);
+        struct stat st{};
+        if (fd<0 || fstat(fd,&st)!=0) { err="cannot open "+path; if(fd>=0) close(fd); return false; }
+        size=(size_t)st.st_size;
+        if (size>=sizeof(Header)) base=mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0);
+        close(fd);
+        if (!base || base==MAP_FAILED) { base=nullptr; err="cannot map "+path; return false; }
+        const Header& h=header();
+        if (memcmp(h.magic,"TOKS",4)!=0 || h.version<1 || h.version>VERSION) {
+            err=path+" is not a version 1-"+std::to_string(VERSION)+" token file"; return false;
+        }
+        // sizes first (each bounded by the file, so the sum cannot overflow)
+        uint64_t room=size-sizeof(Header);
+        if (h.tokenCount>room/sizeof(Record) || h.lineCount>=room/sizeof(uint64_t) || h.stringBytes>room
+            || sizeof(Header)+h.tokenCount*sizeof(Record)+(h.lineCount+1)*sizeof(uint64_t)+h.stringBytes!=size) {
+            err=path+" is truncated or corrupt"; return false;
+        }
+        // then every value later used as an index
+        err=path+" is corrupt";
+        const uint64_t* ls=lineStarts();
+        if (ls[0]!=0 || ls[h.lineCount]!=h.tokenCount) return false;
+        for (uint64_t i=0;i<h.lineCount;++i) if (ls[i]>ls[i+1]) return false;
+        if (h.tokenCount && (h.stringBytes==0 || strings()[h.stringBytes-1]!='\0')) return false;
+        uint8_t maxKind=h.version>=2? STRING : SYMBOL;
+        for (uint64_t i=0;i<h.tokenCount;++i) {
+            const Record& r=records()[i];
+            if (r.kind>maxKind || r.str>=h.stringBytes) return false;
+        }
+        err.clear();
+        return true;
+    }
+    const Header& header() const { return *static_cast<const Header*>(base); }
+    uint64_t lines() const { return header().lineCount; }
+    // records of line i (0-based) are [first(i), first(i+1))
+    uint64_t first(uint64_t i) const { return lineStarts()[i]; }
+    const Record& token(uint64_t i) const { return records()[i]; }
+    const char* text(const Record& r) const { return strings()+r.str; }
+private:
+    void* base=nullptr; size_t size=0;
+    const char* bytes() const { return static_cast<const char*>(base); }
+    const Record* records() const { return reinterpret_cast<const Record*>(bytes()+sizeof(Header)); }
+    const uint64_t* lineStarts() const { return reinterpret_cast<const uint64_t*>(records()+header().tokenCount); }
+    const char* strings() const { return reinterpret_cast<const char*>(lineStarts()+header().lineCount+1); }
+};
+
+} // namespace toks
+
+#endif
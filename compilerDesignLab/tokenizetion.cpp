@@ -3,6 +3,7 @@
 #include <sstream>
 #include <vector>
 #include <cctype>
+#include "tokenStream.h"
 using namespace std;
 
 // Function to check if a string is an operator
@@ -54,25 +55,51 @@ vector<string> tokenize(const string &line) {
     return tokens;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Optional: --bin FILE also writes the binary token stream (tokenStream.h)
+    // that semantic.cpp and main.cpp can read with --tokens FILE instead of re-lexing.
+    // It keeps every symbol with its offset and line, unlike the listing below.
+    string binFile;
+    if (argc == 3 && string(argv[1]) == "--bin") {
+        binFile = argv[2];
+    } else if (argc != 1) {
+        cerr << "Usage: " << argv[0] << " [--bin FILE]" << endl;
+        return 1;
+    }
+
     ifstream fin("editor.txt");
     if (!fin.is_open()) {
         cerr << "Error: Cannot open editor.txt" << endl;
         return 1;
     }
 
+    toks::Writer bin;
+    if (!binFile.empty() && !bin.open(binFile)) {
+        cerr << "Error: Cannot write " << binFile << endl;
+        return 1;
+    }
+
     string line;
     vector<string> allTokens;
+    uint64_t offset = 0;     // byte offset of the current line in editor.txt
+    uint32_t lineNo = 0;
 
     cout << "Tokenizing file content...\n\n";
 
     while (getline(fin, line)) {
         vector<string> tokens = tokenize(line);
         allTokens.insert(allTokens.end(), tokens.begin(), tokens.end());
+        if (!binFile.empty()) toks::scanLine(bin, line, ++lineNo, offset);
+        offset += line.size() + (fin.eof() ? 0 : 1);   // +1 for the '\n' getline consumed
     }
 
     fin.close();
 
+    if (!binFile.empty() && !bin.finish(offset)) {
+        cerr << "Error: Cannot write " << binFile << endl;
+        return 1;
+    }
+
     cout << "Tokens found:\n";
     for (const auto &t : allTokens) {
         cout << "[" << t << "] ";